@@ -29,6 +29,7 @@ OBJS =  \
     type.o             \
     vectorT.o	       \
     vector.o           \
+    vm.o               \
     mu-char.o          \
     mu-cons.o          \
     mu-env.o           \
@@ -5,7 +5,7 @@
 
 libmu.so: libmu.a
 	@$(AR) x libmu.a
-	@$(CXX) -shared *.o -o libmu.so
+	@$(CXX) -shared -pthread *.o -o libmu.so
 	@rm -f *.o *__.SYMDEF*
 
 clean:
@@ -13,15 +13,18 @@
  **/
 #include "libmu/compiler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
 #include <map>
+#include <tuple>
 #include <utility>
 
 #include "libmu/core.h"
 #include "libmu/env.h"
 #include "libmu/macro.h"
 #include "libmu/type.h"
+#include "libmu/vm.h"
 
 #include "libmu/types/condition.h"
 #include "libmu/types/cons.h"
@@ -34,27 +37,65 @@ namespace libmu {
 namespace core {
 namespace {
 
+/** * compile time evaluation is outside the lexical environment **/
+/* macro expanders and :defsym values run while the enclosing lambda is
+ * compiled, anything they compile is top level. the lambdas and blocks
+ * being compiled are roots meanwhile. they can collect, so the forms
+ * compiled so far are rooted where they're held. */
+typedef struct toplevel {
+  explicit toplevel(Env* env) : env(env), nlex(env->lexenv_.size()) {
+    env->roots_.insert(env->roots_.end(), env->lexenv_.begin(),
+                       env->lexenv_.end());
+    env->lexenv_.clear();
+  }
+
+  ~toplevel() {
+    env->lexenv_.assign(env->roots_.end() - nlex, env->roots_.end());
+    env->roots_.resize(env->roots_.size() - nlex);
+  }
+
+  Env* env;    /* environment */
+  size_t nlex; /* lambdas being compiled */
+} TopLevel;
+
 /** * compile a list of forms **/
 auto List(Env* env, Tag list) {
-  std::vector<Tag> vlist;
+  Env::RootMark vlist(env);
   Cons::cons_iter<Tag> iter(list);
 
   for (auto it = iter.begin(); it != iter.end(); it = ++iter)
-    vlist.push_back(Compile(env, it->car));
+    vlist.push(Compile(env, it->car));
 
-  return Cons::List(env, vlist);
+  return Cons::List(env, vlist.roots());
 }
 
 /** * is this symbol in the lexical environment? **/
-auto LexicalEnv(Env* env, Tag sym) -> std::pair<Tag, size_t> {
+/* depth counts lambdas out from the innermost one. a block's symbols are
+ * slots in the frame of the lambda it's inlined in. */
+auto LexicalEnv(Env* env, Tag sym) -> std::tuple<Tag, size_t, size_t> {
   assert(Symbol::IsType(sym) || Symbol::IsKeyword(sym));
 
-  auto not_found = std::pair<Tag, size_t>{env->nil_, 0};
+  auto not_found = std::tuple<Tag, size_t, size_t>{env->nil_, 0, 0};
 
   if (Symbol::IsKeyword(sym)) return not_found;
 
+  size_t depth = 0;
   std::vector<Tag>::reverse_iterator it;
   for (it = env->lexenv_.rbegin(); it != env->lexenv_.rend(); ++it) {
+    if (Cons::IsType(*it)) { /* (base nslots . symbols) */
+      auto base = Fixnum::Uint64Of(Cons::car(*it));
+      auto symbols = Cons::cdr(Cons::cdr(*it));
+
+      for (size_t i = 0; i < Cons::Length(env, symbols); ++i) {
+        if (Type::Eq(sym, Cons::Nth(symbols, i)))
+          return std::tuple<Tag, size_t, size_t>{
+              *std::find_if(it, env->lexenv_.rend(), Function::IsType), depth,
+              base + i};
+      }
+
+      continue;
+    }
+
     assert(Function::IsType(*it));
 
     auto lexicals = core::lexicals(Cons::car(Function::form(*it)));
@@ -62,13 +103,72 @@ auto LexicalEnv(Env* env, Tag sym) -> std::pair<Tag, size_t> {
 
     for (size_t i = 0; i < Cons::Length(env, lexicals); ++i) {
       if (Type::Eq(sym, Cons::Nth(lexicals, i)))
-        return std::pair<Tag, size_t>{*it, i};
+        return std::tuple<Tag, size_t, size_t>{*it, depth, i};
     }
+
+    depth++;
   }
 
   return not_found;
 }
 
+/** * first free slot in the innermost frame **/
+auto FrameTop(Env* env) -> size_t {
+  assert(!env->lexenv_.empty());
+
+  auto top = env->lexenv_.back();
+
+  return Cons::IsType(top)
+             ? Fixnum::Uint64Of(Cons::car(top)) +
+                   Fixnum::Uint64Of(Cons::car(Cons::cdr(top)))
+             : Cons::Length(env, core::lexicals(Cons::car(Function::form(top))));
+}
+
+/** * ((:lambda (symbol...) . body) form...) **/
+/* a lambda applied where it's defined, inside another lambda, is a block.
+ * its symbols are slots in the enclosing frame, its body runs in place.
+ * anything else is compiled as a call. */
+auto Block(Env* env, Tag form) -> Tag {
+  auto lambda = Cons::car(form);
+  auto values = Cons::cdr(form);
+
+  if (env->lexenv_.empty() ||
+      !Type::Eq(Cons::car(lambda), Symbol::Keyword("lambda")) ||
+      !Cons::IsType(Cons::cdr(lambda)))
+    return Type::NIL;
+
+  auto symbols = Cons::car(Cons::cdr(lambda));
+  auto body = Cons::cdr(Cons::cdr(lambda));
+
+  if (!Cons::IsList(symbols) || !Cons::IsList(values) ||
+      Cons::Length(env, symbols) != Cons::Length(env, values))
+    return Type::NIL;
+
+  std::vector<Tag> seen;
+  Cons::cons_iter<Tag> iter(symbols);
+  for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
+    if (!Symbol::IsType(it->car) || Symbol::IsKeyword(it->car) ||
+        std::find(seen.begin(), seen.end(), it->car) != seen.end())
+      return Type::NIL;
+    seen.push_back(it->car);
+  }
+
+  auto base = Fixnum(FrameTop(env)).tag_;
+  auto nslots = Fixnum(seen.size()).tag_;
+
+  /* the values can't see the symbols, but their slots are taken */
+  env->lexenv_.push_back(
+      Cons::Make(env, base, Cons::Make(env, nslots, Type::NIL)));
+  auto cvalues = List(env, values);
+  Env::Root root(env, cvalues);
+  env->lexenv_.back() = Cons::Make(env, base, Cons::Make(env, nslots, symbols));
+  auto cbody = List(env, body);
+  env->lexenv_.pop_back();
+
+  return Cons::Make(env, Symbol::Keyword("let"),
+                    Cons::Make(env, base, Cons::Make(env, cvalues, cbody)));
+}
+
 /** * compile lambda definition **/
 auto Lambda(Env* env, Tag form) {
   assert(Cons::IsList(form));
@@ -128,20 +228,24 @@ auto Lambda(Env* env, Tag form) {
                        lambda);
 
     /** * ((lexicals...) . restsym) */
-    return Cons(Cons::List(env, lexicals), restsym).Evict(env);
+    return Cons::Make(env, Cons::List(env, lexicals), restsym);
   };
 
   auto lambda = parse_lambda(env, Cons::car(form));
 
   auto fn = Function(env, Type::NIL, std::vector<Frame*>{}, lambda,
-                     Cons(lambda, Type::NIL).tag_)
+                     Cons::Make(env, lambda, Type::NIL))
                 .Evict(env);
+  Env::Root root(env, fn);
 
-  if (Function::arity(fn)) env->lexenv_.push_back(fn);
+  /* every lambda is a link in the static chain, with arguments or not */
+  env->lexenv_.push_back(fn);
 
-  Function::form(fn, Cons(lambda, List(env, Cons::cdr(form))).Evict(env));
+  Function::form(env, fn, Cons::Make(env, lambda, List(env, Cons::cdr(form))));
+  Function::code(env, fn,
+                 Assemble(env, Cons::cdr(Function::form(fn)), FrameTop(env)));
 
-  if (Function::arity(fn)) env->lexenv_.pop_back();
+  env->lexenv_.pop_back();
 
   return fn;
 }
@@ -168,7 +272,15 @@ auto DefSymbol(Env* env, Tag form) {
     Condition::Raise(env, Condition::CONDITION_CLASS::CELL_ERROR,
                      "symbol previously bound (:defsym)", sym);
   env->src_form_ = form;
-  auto value = Eval(env, Compile(env, expr));
+
+  Tag value;
+  {
+    TopLevel toplevel(env);
+    auto compiled = Compile(env, expr);
+    Env::Root root(env, compiled);
+
+    value = Eval(env, compiled);
+  }
 
   Tag defsym;
 
@@ -180,9 +292,9 @@ auto DefSymbol(Env* env, Tag form) {
   else
     assert(false);
 
-  (void)Symbol::Bind(defsym, value);
+  (void)Symbol::Bind(env, defsym, value);
 
-  if (Function::IsType(value)) Function::name(value, defsym);
+  if (Function::IsType(value)) Function::name(env, value, defsym);
 
   return Cons::List(env, std::vector<Tag>{Symbol::Keyword("quote"), defsym});
 }
@@ -233,21 +345,59 @@ auto Letq(Env* env, Tag form) {
   auto sym = Cons::Nth(args, 0);
   auto expr = Cons::Nth(args, 1);
 
-  if (!Symbol::IsType(sym))
+  if (!Symbol::IsType(sym) && !IsLexRef(sym))
     Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR, ":letq", sym);
 
   auto lsym = Compile(env, sym);
 
-  if (!Cons::IsList(lsym))
+  if (!IsLexRef(lsym))
     Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR, ":letq",
                      lsym);
 
-  auto letq = Namespace::FindInterns(env->mu_, String(env, "letq").tag_);
-  assert(!Type::Null(letq));
+  return Cons::List(env, std::vector<Tag>{Symbol::Keyword("letq"), lsym,
+                                          Compile(env, expr)});
+}
+
+/** * (:lexref depth . offset) **/
+auto LexRef(Env* env, Tag form) {
+  if (!IsLexRef(form))
+    Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR, ":lexref",
+                     form);
 
-  return Cons::List(
-      env, std::vector<Tag>{letq, Cons::Nth(lsym, 1), Cons::Nth(lsym, 2),
-                            Compile(env, expr)});
+  return form;
+}
+
+/** * (:let base (form...) . body) **/
+/* a block written out takes the next free slots of the enclosing frame,
+ * like one inlined by Block. its slots have no symbols. */
+auto Let(Env* env, Tag form) {
+  if (Cons::Length(env, form) < 3 || !Fixnum::IsType(Cons::Nth(form, 1)) ||
+      !Cons::IsList(Cons::Nth(form, 2)))
+    Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR, ":let",
+                     form);
+
+  if (env->lexenv_.empty())
+    Condition::Raise(env, Condition::CONDITION_CLASS::CONTROL_ERROR,
+                     ":let: no enclosing frame", form);
+
+  auto base = Cons::Nth(form, 1);
+  auto values = Cons::Nth(form, 2);
+
+  if (Fixnum::Uint64Of(base) != FrameTop(env))
+    Condition::Raise(env, Condition::CONDITION_CLASS::PROGRAM_ERROR,
+                     ":let: base", base);
+
+  auto nslots = Fixnum(Cons::Length(env, values)).tag_;
+
+  env->lexenv_.push_back(
+      Cons::Make(env, base, Cons::Make(env, nslots, Type::NIL)));
+  auto cvalues = List(env, values);
+  Env::Root root(env, cvalues);
+  auto cbody = List(env, Cons::cdr(Cons::cdr(Cons::cdr(form))));
+  env->lexenv_.pop_back();
+
+  return Cons::Make(env, Symbol::Keyword("let"),
+                    Cons::Make(env, base, Cons::Make(env, cvalues, cbody)));
 }
 
 /** * (:quote object) **/
@@ -281,7 +431,9 @@ auto Nil(Env* env, Tag form) {
 static const std::map<Tag, std::function<Tag(Env*, Tag)>> kSpecMap{
     {Symbol::Keyword("defsym"), DefSymbol},
     {Symbol::Keyword("lambda"), DefLambda},
+    {Symbol::Keyword("let"), Let},
     {Symbol::Keyword("letq"), Letq},
+    {Symbol::Keyword("lexref"), LexRef},
     {Symbol::Keyword("macro"), DefMacro},
     {Symbol::Keyword("quote"), Quote},
     {Symbol::Keyword("t"), T},
@@ -289,6 +441,24 @@ static const std::map<Tag, std::function<Tag(Env*, Tag)>> kSpecMap{
 
 } /* anonymous namespace */
 
+/** * lexical variable reference, (:lexref depth . offset) **/
+auto MakeLexRef(Env* env, size_t depth, size_t offset) -> Tag {
+  return Cons::Make(env, Symbol::Keyword("lexref"),
+                    Cons::Make(env, Fixnum(depth).tag_, Fixnum(offset).tag_));
+}
+
+/** * lexical variable reference predicate **/
+auto IsLexRef(Tag form) -> bool {
+  if (!Cons::IsType(form) ||
+      !Type::Eq(Cons::car(form), Symbol::Keyword("lexref")))
+    return false;
+
+  auto ref = Cons::cdr(form);
+
+  return Cons::IsType(ref) && Fixnum::IsType(Cons::car(ref)) &&
+         Fixnum::IsType(Cons::cdr(ref));
+}
+
 /** * special operator predicate **/
 auto IsSpecOp(Tag symbol) -> bool {
   return Symbol::IsKeyword(symbol) && (kSpecMap.count(symbol) != 0);
@@ -304,17 +474,26 @@ auto Compile(Env* env, Tag form) -> Tag {
 
       switch (Type::TypeOf(fn)) {
         case SYS_CLASS::CONS: /* fn is list form */
-          rval = List(env, form);
+          rval = Block(env, form);
+          if (Type::Null(rval)) rval = List(env, form);
           break;
         case SYS_CLASS::SYMBOL: { /* funcall/macro call/special call */
           Tag lfn;
 
-          std::tie(lfn, std::ignore) = LexicalEnv(env, fn);
+          std::tie(lfn, std::ignore, std::ignore) = LexicalEnv(env, fn);
           if (Function::IsType(lfn))
             rval = List(env, form);
-          else if (Function::IsType(Macro::MacroFunction(env, fn)))
-            rval = Compile(env, Macro::MacroExpand(env, form));
-          else if (IsSpecOp(fn))
+          else if (Function::IsType(Macro::MacroFunction(env, fn))) {
+            Tag expansion;
+
+            {
+              TopLevel toplevel(env);
+              expansion = Macro::MacroExpand(env, form);
+            }
+
+            Env::Root root(env, expansion);
+            rval = Compile(env, expansion);
+          } else if (IsSpecOp(fn))
             rval = kSpecMap.at(fn)(env, form);
           else if (!Symbol::IsBound(fn))
             Condition::Raise(env, Condition::CONDITION_CLASS::UNBOUND_VARIABLE,
@@ -335,20 +514,11 @@ auto Compile(Env* env, Tag form) -> Tag {
     }
     case SYS_CLASS::SYMBOL: {
       Tag fn;
-      size_t offset;
-
-      std::tie<Tag, size_t>(fn, offset) = LexicalEnv(env, form);
-
-      rval =
-          Function::IsType(fn)
-              ? Compile(env,
-                        Cons::List(
-                            env,
-                            std::vector<Tag>{
-                                Namespace::FindInterns(
-                                    env->mu_, String(env, "frame-ref").tag_),
-                                Function::frame_id(fn), Fixnum(offset).tag_}))
-              : form;
+      size_t depth, offset;
+
+      std::tie(fn, depth, offset) = LexicalEnv(env, form);
+
+      rval = Function::IsType(fn) ? MakeLexRef(env, depth, offset) : form;
       break;
     }
     default: /* constant */
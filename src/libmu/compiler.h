@@ -27,6 +27,9 @@ namespace core {
 Tag Compile(Env*, Tag);
 bool IsSpecOp(Tag);
 
+Tag MakeLexRef(Env*, size_t, size_t);
+bool IsLexRef(Tag);
+
 constexpr auto lexicals(Tag lambda) {
   assert(Cons::IsList(lambda));
 
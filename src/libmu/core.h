@@ -32,6 +32,7 @@ using Tag = Type::Tag;
 
 Tag Apply(Env*, Tag, Tag);
 Tag Eval(Env*, Tag);
+Tag EvalCall(Env*, Tag, Tag);
 
 void Print(Env*, Tag, Tag, bool);
 void PrintStdString(Env*, const std::string&, Tag, bool);
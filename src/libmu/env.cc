@@ -15,8 +15,14 @@
 
 #include "libmu/env.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 #include "libmu/platform/platform.h"
 
@@ -125,6 +131,7 @@ static const std::vector<Env::TagFn> kExtFuncTab{
     {"read", mu::Read, 1},
     {"read-byte", mu::ReadByte, 1},
     {"read-char", mu::ReadChar, 1},
+    {"save-image", mu::SaveImage, 1},
     {"set-macro-character", mu::SetMacroChar, 2},
     {"sin", mu::Sine, 1},
     {"special-operatorp", mu::IsSpecOp, 1},
@@ -159,9 +166,9 @@ static const std::vector<Env::TagFn> kExtFuncTab{
 static const std::vector<Env::TagFn> kIntFuncTab{
     {"block", mu::Block, 2},        {"clock-view", mu::ClockView, 0},
     {"env-view", mu::EnvView, 0},   {"exit", mu::Exit, 1},
-    {"frame-ref", mu::FrameRef, 2}, {"heap-view", mu::HeapInfo, 1},
-    {"invoke", mu::Invoke, 2},      {"letq", mu::Letq, 3},
-    {"return", mu::Return, 2},      {"system", mu::System, 1}};
+    {"gc-config", mu::GcConfig, 2}, {"heap-view", mu::HeapInfo, 1},
+    {"invoke", mu::Invoke, 2},      {"return", mu::Return, 2},
+    {"system", mu::System, 1}};
 
 /** * make vector of frame **/
 auto FrameView(Env* env, Frame* fp) {
@@ -176,6 +183,284 @@ auto FrameView(Env* env, Frame* fp) {
   return Vector(env, frame).tag_;
 }
 
+/** * tagged pointer from heap object header **/
+auto HeapTag(heap::Heap::HeapInfo* hp) -> Tag {
+  switch (heap::Heap::SysClass(*hp)) {
+    case SYS_CLASS::CONS:
+      return Type::Entag(hp + 1, Type::TAG::CONS);
+    case SYS_CLASS::FUNCTION:
+      return Type::Entag(hp + 1, Type::TAG::FUNCTION);
+    case SYS_CLASS::SYMBOL:
+      return Type::Entag(hp + 1, Type::TAG::SYMBOL);
+    default:
+      return Type::Entag(hp + 1, Type::TAG::EXTEND);
+  }
+}
+
+/** * mark environment roots **/
+auto GcRoots(Env* env) -> void {
+  for (auto& ns : env->namespaces_) Env::GcMark(env, ns.second);
+  for (auto& fn : env->lexenv_) Env::GcMark(env, fn);
+  for (auto& root : env->roots_) Env::GcMark(env, root);
+  for (size_t i = 0; i < env->argp_; ++i) Env::GcMark(env, env->args_[i]);
+  for (auto& fp : env->frames_) Env::GcFrame(fp);
+  for (auto& entry : env->readtable_) Env::GcMark(env, entry.second);
+  Env::GcMark(env, env->src_form_);
+}
+
+/** * accumulate collection pause **/
+auto GcPause(Env* env, heap::Heap::GcStats* stats, uint64_t start) -> void {
+  uint64_t stop;
+
+  Platform::SystemTime(&stop);
+
+  stats->ncollections++;
+  stats->last_usecs = stop - start;
+  stats->usecs += stats->last_usecs;
+  env->heap_->Pause(stats->last_usecs);
+}
+
+/** * heap object with a header we can mark **/
+auto IsHeapObject(Env* env, Tag ptr) -> bool {
+  return !Type::IsImmediate(ptr) && !Fixnum::IsType(ptr) &&
+         (env->heap_->in_heap(reinterpret_cast<void*>(ptr)) ||
+          env->heap_->is_large(reinterpret_cast<void*>(ptr)));
+}
+
+/** * gray stack of a parallel mark worker, the env's otherwise **/
+thread_local std::vector<Tag>* tls_gray = nullptr;
+
+/** * mark object, queue its references. false if already marked **/
+template <bool ATOMIC>
+auto GcScan(Env* env, Tag ptr) -> bool {
+  auto hp = Type::Untag<heap::Heap::HeapInfo>(ptr) - 1;
+
+  if (!(ATOMIC ? env->heap_->TryMarkAtomic(hp) : env->heap_->TryMark(hp)))
+    return false;
+
+  auto& entry = Type::TraitsOf(heap::Heap::SysClass(*hp));
+  auto slots = Type::Untag<Tag>(ptr);
+
+  for (size_t i = 0; i < entry.slots.nslots; ++i)
+    Env::GcMark(env, slots[entry.slots.slots[i]]);
+
+  if (entry.scan != nullptr) entry.scan(env, ptr);
+
+  return true;
+}
+
+/** * parallel mark worker **/
+typedef struct {
+  std::vector<Tag> gray;       /* private stack */
+  std::mutex lock;             /* guards shared */
+  std::vector<Tag> shared;     /* work other workers may steal */
+  std::atomic<size_t> nshared; /* shared.size(), readable without lock */
+} GcWorker;
+
+/** * move some private work where others can steal it **/
+auto GcPublish(GcWorker* worker) -> void {
+  static const size_t NPUBLISH = 64;
+
+  if (worker->gray.size() < 2 * NPUBLISH || worker->nshared.load() != 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(worker->lock);
+
+  worker->shared.insert(worker->shared.end(), worker->gray.end() - NPUBLISH,
+                        worker->gray.end());
+  worker->gray.resize(worker->gray.size() - NPUBLISH);
+  worker->nshared.store(worker->shared.size());
+}
+
+/** * take half of some worker's shared work **/
+auto GcSteal(GcWorker* workers, size_t nworkers, size_t self) -> bool {
+  for (size_t n = 0; n < nworkers; ++n) {
+    auto victim = &workers[(self + n) % nworkers];
+
+    if (victim->nshared.load() == 0) continue;
+
+    std::lock_guard<std::mutex> lock(victim->lock);
+    auto nsteal = (victim->shared.size() + 1) / 2;
+
+    if (nsteal == 0) continue;
+
+    auto& gray = workers[self].gray;
+    gray.insert(gray.end(), victim->shared.end() - nsteal,
+                victim->shared.end());
+    victim->shared.resize(victim->shared.size() - nsteal);
+    victim->nshared.store(victim->shared.size());
+
+    return true;
+  }
+
+  return false;
+}
+
+/** * drain private work, steal more, quit when everyone is idle **/
+auto GcMarkWorker(Env* env, GcWorker* workers, size_t nworkers, size_t self,
+                  std::atomic<size_t>* nidle) -> void {
+  auto& gray = workers[self].gray;
+  size_t nbytes = 0;
+
+  tls_gray = &gray;
+
+  for (;;) {
+    while (!gray.empty()) {
+      auto ptr = gray.back();
+      auto hp = Type::Untag<heap::Heap::HeapInfo>(ptr) - 1;
+
+      gray.pop_back();
+      if (!gray.empty())
+        __builtin_prefetch(Type::Untag<heap::Heap::HeapInfo>(gray.back()) - 1,
+                           1);
+      if (GcScan<true>(env, ptr)) nbytes += heap::Heap::Size(*hp);
+      GcPublish(&workers[self]);
+    }
+
+    if (GcSteal(workers, nworkers, self)) continue;
+
+    /* idle workers hold no work, so all idle means nothing is left */
+    nidle->fetch_add(1);
+    for (;;) {
+      if (nidle->load() == nworkers) {
+        env->heap_->AddMarked(nbytes);
+        tls_gray = nullptr;
+        return;
+      }
+
+      auto nshared = size_t{0};
+      for (size_t n = 0; n < nworkers; ++n)
+        nshared += workers[n].nshared.load();
+
+      if (nshared) {
+        nidle->fetch_sub(1);
+        break;
+      }
+
+      std::this_thread::yield();
+    }
+  }
+}
+
+/** * mark from the gray stack on nthreads threads **/
+/* the queued roots are dealt out to the workers. the caller's thread is
+ * worker 0. */
+auto GcDrainParallel(Env* env, size_t nthreads) -> void {
+  std::unique_ptr<GcWorker[]> workers(new GcWorker[nthreads]);
+  std::atomic<size_t> nidle{0};
+  std::vector<std::thread> threads;
+
+  for (size_t n = 0; n < nthreads; ++n) workers[n].nshared.store(0);
+  for (size_t i = 0; i < env->gray_.size(); ++i)
+    workers[i % nthreads].gray.push_back(env->gray_[i]);
+  env->gray_.clear();
+
+  for (size_t n = 1; n < nthreads; ++n)
+    threads.emplace_back(GcMarkWorker, env, workers.get(), nthreads, n,
+                         &nidle);
+
+  GcMarkWorker(env, workers.get(), nthreads, 0, &nidle);
+
+  for (auto& thread : threads) thread.join();
+}
+
+/** * mark from the gray stack **/
+/* objects are marked as they come off the stack. a short fifo between the
+ * stack and the scan gives their prefetched headers time to arrive. with a
+ * budget, returns false if it ran out before the stack drained. */
+auto GcDrain(Env* env, uint64_t usecs) -> bool {
+  static const size_t NPREFETCH = 8;
+  static const size_t NSCANS_PER_CHECK = 64;
+
+  auto& gray = env->gray_;
+  Tag fifo[NPREFETCH];
+  size_t head = 0, nfifo = 0, nscans = 0;
+  uint64_t start = 0, now;
+
+  if (usecs == 0 && env->mark_threads_ > 1) {
+    GcDrainParallel(env, env->mark_threads_);
+    return true;
+  }
+
+  if (usecs) Platform::SystemTime(&start);
+
+  for (;;) {
+    for (; nfifo < NPREFETCH && !gray.empty(); ++nfifo) {
+      auto ptr = gray.back();
+
+      gray.pop_back();
+      __builtin_prefetch(Type::Untag<heap::Heap::HeapInfo>(ptr) - 1, 1);
+      fifo[(head + nfifo) % NPREFETCH] = ptr;
+    }
+
+    if (nfifo == 0) return true;
+
+    (void)GcScan<false>(env, fifo[head]);
+    head = (head + 1) % NPREFETCH;
+    nfifo--;
+
+    if (usecs && ++nscans == NSCANS_PER_CHECK) {
+      nscans = 0;
+      Platform::SystemTime(&now);
+      if (now - start >= usecs) {
+        for (; nfifo; --nfifo, head = (head + 1) % NPREFETCH)
+          gray.push_back(fifo[head]);
+        return false;
+      }
+    }
+  }
+}
+
+/** * end a mark cycle, its gray stack drained **/
+auto GcEnd(Env* env) -> size_t {
+  env->marking_ = false;
+  env->heap_->black_ = false;
+
+  auto nfree = env->heap_->Gc();
+  env->remembered_.clear();
+  env->gc_pending_ = false;
+  env->heap_->major_.ncollections++;
+
+  return nfree;
+}
+
+/** * stop the world collection, root is any other tag the caller holds **/
+auto GcMajor(Env* env, Tag root) -> size_t {
+  if (env->marking_) return Env::GcFinish(env);
+
+  uint64_t start;
+
+  Platform::SystemTime(&start);
+  env->heap_->ClearMarks();
+
+  GcRoots(env);
+  Env::GcMark(env, root);
+  (void)GcDrain(env, 0);
+
+  auto nfree = env->heap_->Gc();
+  env->remembered_.clear();
+  env->gc_pending_ = false;
+
+  GcPause(env, &env->heap_->major_, start);
+  return nfree;
+}
+
+/** * heap size option in megabytes, as pages **/
+auto HeapPages(Platform* platform, const std::string& key, size_t mbytes)
+    -> size_t {
+  auto opt = platform->Find(key);
+
+  if (platform->IsFound(opt)) {
+    auto value = Platform::value(opt);
+    char* end;
+    auto n = std::strtoul(value.c_str(), &end, 10);
+
+    if (*end == '\0' && n > 0) mbytes = n;
+  }
+
+  return mbytes * 1024 * 1024 / Platform::PAGESIZE;
+}
+
 } /* anonymous namespace */
 
 /** * make vector of env stack **/
@@ -217,14 +502,511 @@ void Env::GcFrame(Frame* fp) {
 }
 
 /** * gc environment **/
-auto Env::Gc(Env* env) -> size_t {
-  env->heap_->ClearRefBits();
+auto Env::Gc(Env* env) -> size_t { return GcMajor(env, Type::NIL); }
+
+/** * run a pending collection **/
+/* a cycle already marking finishes in its slices */
+auto Env::GcPending(Env* env) -> void {
+  if (env->marking_) return;
+
+  if (env->slice_usecs_)
+    GcStart(env);
+  else
+    (void)GcMajor(env, Type::NIL);
+}
+
+/** * start incremental mark cycle **/
+/* snapshot at the beginning: the roots are queued now, objects allocated
+ * during the cycle are black, and the write barrier queues any reference
+ * overwritten before it is scanned. everything reachable at the start of
+ * the cycle survives it. */
+auto Env::GcStart(Env* env) -> void {
+  assert(!env->marking_);
+
+  uint64_t start;
+
+  Platform::SystemTime(&start);
+  env->heap_->ClearMarks();
+  env->heap_->black_ = true;
+  env->marking_ = true;
+  env->slice_bytes_ = 0;
+  env->gc_pending_ = false;
+
+  GcRoots(env);
+
+  uint64_t stop;
+
+  Platform::SystemTime(&stop);
+  env->heap_->major_.last_usecs = stop - start;
+  env->heap_->major_.usecs += stop - start;
+  env->heap_->Pause(stop - start);
+}
+
+/** * mark for one slice, sweep when the gray stack drains **/
+auto Env::GcSlice(Env* env) -> void {
+  assert(env->marking_);
+
+  uint64_t start, now;
+
+  Platform::SystemTime(&start);
+  env->slice_bytes_ = 0;
+
+  if (GcDrain(env, env->slice_usecs_)) (void)GcEnd(env);
+
+  Platform::SystemTime(&now);
+  env->heap_->major_.last_usecs = now - start;
+  env->heap_->major_.usecs += now - start;
+  env->heap_->Pause(now - start);
+}
+
+/** * drain the gray stack and sweep **/
+/* a finish is forced, by exhaustion or a collection asked for, and drains
+ * whatever the slices left gray in one pause. it's reported apart from the
+ * slice pauses. */
+auto Env::GcFinish(Env* env) -> size_t {
+  assert(env->marking_);
+
+  uint64_t start, stop;
+
+  Platform::SystemTime(&start);
+
+  /* frames pushed during the cycle are cheap to take again */
+  GcRoots(env);
+  (void)GcDrain(env, 0);
+
+  auto nfree = GcEnd(env);
+
+  Platform::SystemTime(&stop);
+  env->heap_->major_.last_usecs = stop - start;
+  env->heap_->major_.usecs += stop - start;
+  env->heap_->max_finish_ = std::max(env->heap_->max_finish_, stop - start);
+
+  return nfree;
+}
+
+/** * gc nursery **/
+/* old objects keep their ref bits between collections, so marking stops at
+ * the nursery boundary. old objects written since the last collection are
+ * unmarked and traced again. a mark cycle in progress is finished instead. */
+auto Env::GcMinor(Env* env) -> size_t {
+  if (env->marking_) return GcFinish(env);
+
+  uint64_t start;
+
+  Platform::SystemTime(&start);
+
+  for (auto hp : *env->heap_->remembered_) {
+    env->heap_->Unmark(hp);
+    GcMark(env, HeapTag(hp));
+  }
+
+  for (auto fp : env->remembered_) GcFrame(fp);
+  GcRoots(env);
+  (void)GcDrain(env, 0);
+
+  auto nfree = env->heap_->GcMinor();
+  env->remembered_.clear();
+
+  GcPause(env, &env->heap_->minor_, start);
+  return nfree;
+}
+
+/** * forward frame **/
+auto Env::ForwardFrame(Frame* fp) -> void {
+  fp->func = Forward(fp->env, fp->func);
+  for (size_t i = 0; i < fp->nargs; ++i)
+    fp->argv[i] = Forward(fp->env, fp->argv[i]);
+}
+
+/** * relocate heap object **/
+auto Env::GcRelocate(Env* env, Tag ptr) -> void {
+  auto relocate = Type::TraitsOf(Type::TypeOf(ptr)).relocate;
+
+  if (relocate != nullptr) relocate(env, ptr);
+}
+
+/** * compacting collection **/
+/* objects slide down over the dead in allocation order. every tag in the
+ * heap and the environment is rewritten, so this only runs when there are
+ * no active frames. root is any other tag the caller holds. */
+auto Env::Compact(Env* env, Tag root) -> Tag {
+  uint64_t start;
+
+  assert(env->frames_.empty());
 
-  for (auto& ns : env->namespaces_) GcMark(env, ns.second);
-  for (auto& fn : env->lexenv_) GcMark(env, fn);
-  for (auto& fp : env->frames_) GcFrame(fp);
+  if (env->marking_) (void)GcFinish(env);
 
-  return env->heap_->Gc();
+  Platform::SystemTime(&start);
+  env->heap_->ClearMarks();
+
+  GcRoots(env);
+  GcMark(env, root);
+  (void)GcDrain(env, 0);
+
+  env->heap_->Relocate();
+  env->heap_->MapHeap([env](heap::Heap::HeapInfo* hp) {
+    if (env->heap_->IsMarked(hp)) GcRelocate(env, HeapTag(hp));
+  });
+
+  /* large objects stay put, their references move */
+  env->heap_->MapLarge([env](heap::Heap::HeapInfo* hp) {
+    if (env->heap_->IsMarked(hp)) GcRelocate(env, HeapTag(hp));
+  });
+
+  for (auto& ns : env->namespaces_) ns.second = Forward(env, ns.second);
+  for (auto& fn : env->lexenv_) fn = Forward(env, fn);
+  for (auto& root : env->roots_) root = Forward(env, root);
+  for (size_t i = 0; i < env->argp_; ++i)
+    env->args_[i] = Forward(env, env->args_[i]);
+  for (auto& entry : env->readtable_)
+    entry.second = Forward(env, entry.second);
+
+  env->mu_ = Forward(env, env->mu_);
+  env->namespace_ = Forward(env, env->namespace_);
+  env->src_form_ = Forward(env, env->src_form_);
+  env->standard_input_ = Forward(env, env->standard_input_);
+  env->standard_output_ = Forward(env, env->standard_output_);
+  env->standard_error_ = Forward(env, env->standard_error_);
+  root = Forward(env, root);
+
+  env->heap_->Compact();
+  env->remembered_.clear();
+  env->compact_ = false;
+
+  GcPause(env, &env->heap_->major_, start);
+  return root;
+}
+
+/** * collect at a safe point **/
+/* the top level holds no heap tags on the C++ stack, value aside, so the
+ * collections put off by allocation run here. */
+auto Env::SafePoint(Env* env, Tag value) -> Tag {
+  if (!env->frames_.empty() || !env->roots_.empty() || env->argp_)
+    return value;
+
+  if (!env->image_.empty()) {
+    auto path = env->image_;
+
+    env->image_.clear();
+    value = Compact(env, value);
+    if (!SaveImage(env, path))
+      Condition::Raise(env, Condition::CONDITION_CLASS::FILE_ERROR,
+                       "can't save image (save-image)",
+                       String(env, path).tag_);
+
+    return value;
+  }
+
+  if (env->compact_) return Compact(env, value);
+  if (env->gc_pending_ || env->heap_->due()) (void)GcMajor(env, value);
+
+  return value;
+}
+
+/** * save heap image **/
+/* marked objects are live, the rest are free. the words after the roots
+ * rebuild what isn't in the heap: the core function each function is
+ * bound to, and closure contexts. */
+auto Env::SaveImage(Env* env, const std::string& path) -> bool {
+  std::vector<uint64_t> words;
+
+  auto push = [&words](uint64_t word) { words.push_back(word); };
+  auto push_tag = [&words](Tag tag) {
+    words.push_back(Type::to_underlying(tag));
+  };
+
+  push(kExtFuncTab.size() + kIntFuncTab.size());
+  push(env->frame_id_);
+  push(env->ns_epoch_);
+  push_tag(env->mu_);
+  push_tag(env->namespace_);
+  push_tag(env->standard_input_);
+  push_tag(env->standard_output_);
+  push_tag(env->standard_error_);
+
+  push(env->namespaces_.size());
+  for (auto& ns : env->namespaces_) push_tag(ns.second);
+
+  push(env->readtable_.size());
+  for (auto& entry : env->readtable_) {
+    push_tag(entry.first);
+    push_tag(entry.second);
+  }
+
+  push(env->lexenv_.size());
+  for (auto fn : env->lexenv_) push_tag(fn);
+
+  std::vector<Tag> functions;
+
+  env->heap_->MapHeap([env, &functions](heap::Heap::HeapInfo* hp) {
+    auto ptr = HeapTag(hp);
+
+    if (!env->heap_->IsMarked(hp)) return;
+    if (Function::IsType(ptr)) functions.push_back(ptr);
+  });
+
+  /* core functions by table index, -1 for lambdas */
+  push(functions.size());
+  for (auto fn : functions) {
+    uint64_t index = -1;
+
+    if (!Type::Null(Function::mu(fn))) {
+      auto mu = env->CoreFunction(Function::mu(fn));
+
+      index = (mu >= kExtFuncTab.data() &&
+               mu < kExtFuncTab.data() + kExtFuncTab.size())
+                  ? mu - kExtFuncTab.data()
+                  : kExtFuncTab.size() + (mu - kIntFuncTab.data());
+    }
+
+    push_tag(fn);
+    push(index);
+    push(Function::context(fn).size());
+    for (auto fp : Function::context(fn)) {
+      push_tag(fp->frame_id);
+      push_tag(fp->func);
+      push(fp->nargs);
+      for (size_t i = 0; i < fp->nargs; ++i) push_tag(fp->argv[i]);
+    }
+  }
+
+  return env->heap_->SaveImage(path, words);
+}
+
+/** * map heap image into a new environment **/
+/* rebasing runs the compactor's relocation over the live objects, the
+ * free ones are left to the sweep. open streams other than the standard
+ * streams don't survive. */
+auto Env::LoadImage(Env* env, const std::string& path) -> bool {
+  std::vector<uint64_t> words;
+
+  if (!env->heap_->LoadImage(path, &words)) return false;
+
+  size_t nword = 0;
+  auto next = [&words, &nword]() {
+    assert(nword < words.size());
+    return words[nword++];
+  };
+  auto next_tag = [env, &next]() {
+    return Forward(env, static_cast<Tag>(next()));
+  };
+
+  if (next() != kExtFuncTab.size() + kIntFuncTab.size())
+    assert(!"image function table botch");
+
+  env->heap_->MapHeap([env](heap::Heap::HeapInfo* hp) {
+    auto ptr = HeapTag(hp);
+
+    if (!env->heap_->IsMarked(hp)) return;
+    if (Function::IsType(ptr)) Function::ImageReset(ptr);
+    if (env->heap_->rebasing()) GcRelocate(env, ptr);
+  });
+
+  if (env->heap_->rebasing())
+    env->heap_->MapLarge([env](heap::Heap::HeapInfo* hp) {
+      GcRelocate(env, HeapTag(hp));
+    });
+
+  env->frame_id_ = next();
+  env->ns_epoch_ = next();
+  env->mu_ = next_tag();
+  env->namespace_ = next_tag();
+  env->standard_input_ = next_tag();
+  env->standard_output_ = next_tag();
+  env->standard_error_ = next_tag();
+
+  for (auto n = next(); n; --n) {
+    auto ns = next_tag();
+
+    env->namespaces_[String::StdStringOf(Namespace::name(ns))] = ns;
+  }
+
+  for (auto n = next(); n; --n) {
+    auto key = next_tag();
+
+    env->readtable_[key] = next_tag();
+  }
+
+  for (auto n = next(); n; --n) env->lexenv_.push_back(next_tag());
+
+  for (auto n = next(); n; --n) {
+    auto fn = next_tag();
+    auto index = next();
+
+    if (index != static_cast<uint64_t>(-1)) {
+      auto mu = index < kExtFuncTab.size()
+                    ? &kExtFuncTab[index]
+                    : &kIntFuncTab[index - kExtFuncTab.size()];
+
+      (void)Function::mu(fn, Fixnum(reinterpret_cast<uintptr_t>(mu)).tag_);
+    }
+
+    std::vector<Frame*> context;
+
+    for (auto nframes = next(); nframes; --nframes) {
+      auto frame_id = next_tag();
+      auto func = next_tag();
+      auto nargs = next();
+      auto args = new Tag[nargs];
+
+      for (size_t i = 0; i < nargs; ++i) args[i] = next_tag();
+      context.push_back(new Frame(env, frame_id, func, args, nargs));
+    }
+
+    if (!context.empty()) Function::context(env, fn, context);
+  }
+
+  env->heap_->Rebased();
+  return true;
+}
+
+/** * out of committed heap **/
+/* C++ locals are not roots, so no cycle starts from here. a cycle in
+ * progress is finished, and the next one collects what it allocated
+ * black. a sweep in progress is finished and retried. after that, commit
+ * just enough pages to run on until the next gc point collects, the
+ * collection decides whether the heap grows. at the limit, a collection
+ * that is due still gets its pages out of the reserve. only when one has
+ * run and there is still no room, raise a storage condition out of what
+ * is left of the reserve. */
+auto Env::HeapExhausted(Env* env, size_t len, SYS_CLASS tag) -> void* {
+  auto heap = env->heap_.get();
+
+  if (env->marking_) {
+    (void)GcFinish(env);
+    env->gc_pending_ = true;
+  }
+  heap->FinishSweep();
+
+  auto caddr = heap->Alloc(len, tag);
+  if (caddr != nullptr) return caddr;
+
+  auto due = env->gc_pending_ || heap->due();
+
+  env->gc_pending_ = true;
+  if (heap->Grow(len) || (due && heap->Bridge(len)))
+    return heap->Alloc(len, tag);
+
+  if (heap->use_reserve()) assert(!"heap reserve exhausted botch");
+
+  heap->UseReserve();
+  Condition::Raise(env, Condition::CONDITION_CLASS::STORAGE_CONDITION,
+                   "heap exhausted", Type::NIL);
+}
+
+/** * argument stack overflow **/
+/* the marks below the raise pop the stack as it unwinds */
+auto Env::ArgsExhausted(Env* env) -> void {
+  Condition::Raise(env, Condition::CONDITION_CLASS::STORAGE_CONDITION,
+                   "argument stack exhausted", Type::NIL);
+}
+
+/** * allocate large object **/
+/* large objects aren't in the committed heap, so they don't exhaust it.
+ * collect at the next safe point once they've mapped as much again. */
+auto Env::AllocLarge(Env* env, size_t len, SYS_CLASS tag) -> void* {
+  auto heap = env->heap_.get();
+  auto caddr = heap->AllocLarge(len, tag);
+
+  if (caddr == nullptr)
+    Condition::Raise(env, Condition::CONDITION_CLASS::STORAGE_CONDITION,
+                     "can't map large object", Type::NIL);
+
+  if (heap->nlarge_alloc_ > heap->size()) env->gc_pending_ = true;
+
+  return caddr;
+}
+
+/** * clone a warmed up environment **/
+/* the clone maps a snapshot of the heap copy on write, with its own frame
+ * stack, namespace list and standard stream objects. nothing moves in the
+ * parent, the snapshot is collected but not compacted. nullptr if the
+ * snapshot can't be saved or mapped. */
+auto Env::Clone(Env* env) -> Env* {
+  assert(env->frames_.empty());
+
+  auto heap = env->heap_.get();
+  auto use_bitmap = heap->use_bitmap();
+
+  (void)Gc(env);
+  heap->FinishSweep();
+
+  /* liveness goes in the image with the object headers */
+  heap->UseBitmap(false);
+
+  std::string path;
+  auto fd = Platform::OpenTemp("mu-clone", &path);
+
+  auto ok = fd >= 0 && SaveImage(env, path);
+
+  heap->UseBitmap(use_bitmap);
+
+  auto stream_id = [](Tag symbol, Platform::STD_STREAM std) {
+    auto stream = Symbol::value(symbol);
+
+    return Stream::IsType(stream) ? Stream::streamId(stream)
+                                  : Platform::OpenStandardStream(std);
+  };
+
+  auto clone = ok ? new Env(env->platform_,
+                            stream_id(env->standard_input_,
+                                      Platform::STD_STREAM::STDIN),
+                            stream_id(env->standard_output_,
+                                      Platform::STD_STREAM::STDOUT),
+                            stream_id(env->standard_error_,
+                                      Platform::STD_STREAM::STDERR),
+                            path)
+                  : nullptr;
+
+  if (fd >= 0) Platform::CloseTemp(fd);
+
+  /* a clone that couldn't map the snapshot is no clone */
+  if (clone != nullptr && clone->bad_image_) {
+    delete clone;
+    clone = nullptr;
+  }
+
+  return clone;
+}
+
+/** * write barrier on object store **/
+/* while marking, shade the overwritten reference. otherwise remember old
+ * objects that take young references. */
+auto Env::WriteBarrier(Env* env, Tag object, Tag old, Tag value) -> void {
+  if (env->marking_) {
+    GcMark(env, old);
+    return;
+  }
+
+  if (IsYoung(env, value) && IsHeapObject(env, object) &&
+      !IsYoung(env, object))
+    env->heap_->Remember(Type::Untag<heap::Heap::HeapInfo>(object) - 1);
+}
+
+/** * write barrier on context frame store **/
+auto Env::WriteBarrier(Env* env, Frame* fp, Tag old, Tag value) -> void {
+  if (env->marking_) {
+    GcMark(env, old);
+    return;
+  }
+
+  if (!IsYoung(env, value)) return;
+
+  /* active frames are roots */
+  auto active = std::find(env->frames_.rbegin(), env->frames_.rend(), fp);
+  if (active == env->frames_.rend()) env->remembered_.insert(fp);
+}
+
+/** * innermost active frame of a function **/
+/* a lambda that isn't a closure is only called inside the dynamic extent
+ * of its enclosing function, look for that frame in the static chains of
+ * the active frames. */
+auto Env::FindFrame(Env* env, Tag func) -> Frame* {
+  for (auto it = env->frames_.rbegin(); it != env->frames_.rend(); ++it)
+    for (auto fp = *it; fp != nullptr; fp = fp->link)
+      if (Type::Eq(fp->func, func)) return fp;
+
+  return nullptr;
 }
 
 /** grab last frame **/
@@ -237,73 +1019,26 @@ auto Env::LastFrame(Env* env) -> Tag {
 auto Env::Evict(Env* env, Tag ptr) -> Tag {
   if (Env::IsEvicted(env, ptr)) return ptr;
 
-  std::function<Tag(Env*, Tag)> noEvict = [](Env*, Tag ptr) -> Tag {
-    return ptr;
-  };
-  static const std::map<SYS_CLASS, std::function<Tag(Env*, Tag)>> kGcEvictMap{
-      {SYS_CLASS::CHAR, noEvict},
-      {SYS_CLASS::CONS, Cons::EvictTag},
-      {SYS_CLASS::CONDITION, Condition::EvictTag},
-      {SYS_CLASS::DOUBLE, Double::EvictTag},
-      {SYS_CLASS::FIXNUM, noEvict},
-      {SYS_CLASS::FLOAT, noEvict},
-      {SYS_CLASS::FUNCTION, Function::EvictTag},
-      {SYS_CLASS::MACRO, Macro::EvictTag},
-      {SYS_CLASS::NAMESPACE, Namespace::EvictTag},
-      {SYS_CLASS::STREAM, Stream::EvictTag},
-      {SYS_CLASS::STRING, Vector::EvictTag},
-      {SYS_CLASS::STRUCT, Struct::EvictTag},
-      {SYS_CLASS::SYMBOL, Symbol::EvictTag},
-      {SYS_CLASS::VECTOR, Vector::EvictTag}};
-
-  assert(kGcEvictMap.count(Type::TypeOf(ptr)));
-  return kGcEvictMap.at(Type::TypeOf(ptr))(env, ptr);
+  auto evict = Type::TraitsOf(Type::TypeOf(ptr)).evict;
+
+  assert(evict != nullptr);
+  return evict(env, ptr);
 }
 
 /** * garbage collection **/
+/* queue on the gray stack, marked when a drain gets to it */
 auto Env::GcMark(Env* env, Tag ptr) -> void {
-  std::function<void(Env*, Tag)> noGc = [](Env*, Tag) {};
-  static const std::map<SYS_CLASS, std::function<void(Env*, Tag)>> kGcTypeMap{
-      {SYS_CLASS::CHAR, noGc},
-      {SYS_CLASS::CONS, Cons::GcMark},
-      {SYS_CLASS::CONDITION, Condition::GcMark},
-      {SYS_CLASS::DOUBLE, noGc},
-      {SYS_CLASS::FIXNUM, noGc},
-      {SYS_CLASS::FLOAT, noGc},
-      {SYS_CLASS::FUNCTION, Function::GcMark},
-      {SYS_CLASS::MACRO, Macro::GcMark},
-      {SYS_CLASS::NAMESPACE, Namespace::GcMark},
-      {SYS_CLASS::STREAM, Stream::GcMark},
-      {SYS_CLASS::STRING, Vector::GcMark},
-      {SYS_CLASS::STRUCT, Struct::GcMark},
-      {SYS_CLASS::SYMBOL, Symbol::GcMark},
-      {SYS_CLASS::VECTOR, Vector::GcMark}};
-
   assert(IsEvicted(env, ptr));
-  assert(kGcTypeMap.count(Type::TypeOf(ptr)));
-  kGcTypeMap.at(Type::TypeOf(ptr))(env, ptr);
+
+  if (IsHeapObject(env, ptr))
+    (tls_gray == nullptr ? env->gray_ : *tls_gray).push_back(ptr);
 }
 
 /** * make a view vector of pointer's contents **/
 auto Env::ViewOf(Env* env, Tag object) -> Tag {
-  static const std::map<SYS_CLASS, std::function<Tag(Env*, Tag)>> kViewMap{
-      {SYS_CLASS::CHAR, Char::ViewOf},
-      {SYS_CLASS::CONS, Cons::ViewOf},
-      {SYS_CLASS::CONDITION, Condition::ViewOf},
-      {SYS_CLASS::DOUBLE, Double::ViewOf},
-      {SYS_CLASS::FIXNUM, Fixnum::ViewOf},
-      {SYS_CLASS::FUNCTION, Function::ViewOf},
-      {SYS_CLASS::FLOAT, Float::ViewOf},
-      {SYS_CLASS::MACRO, Macro::ViewOf},
-      {SYS_CLASS::NAMESPACE, Namespace::ViewOf},
-      {SYS_CLASS::STRING, String::ViewOf},
-      {SYS_CLASS::STREAM, Stream::ViewOf},
-      {SYS_CLASS::STRUCT, Struct::ViewOf},
-      {SYS_CLASS::SYMBOL, Symbol::ViewOf},
-      {SYS_CLASS::VECTOR, Vector::ViewOf}};
-
-  auto view = kViewMap.count(Type::TypeOf(object)) != 0;
-  return view ? kViewMap.at(Type::TypeOf(object))(env, object) : Type::NIL;
+  auto view = Type::TraitsOf(Type::TypeOf(object)).view;
+
+  return view == nullptr ? Type::NIL : view(env, object);
 }
 
 /** look up namespace by name in environment map **/
@@ -330,17 +1065,57 @@ auto Env::AddNamespace(Env* env, Tag ns) -> void {
 
 /** * env constructor **/
 Env::Env(Platform* platform, Platform::StreamId stdin,
-         Platform::StreamId stdout, Platform::StreamId stderr) {
+         Platform::StreamId stdout, Platform::StreamId stderr)
+    : Env(platform, stdin, stdout, stderr,
+          platform->IsFound(platform->Find("I"))
+              ? Platform::value(platform->Find("I"))
+              : std::string{}) {}
+
+/** * env constructor, from a heap image if there is one **/
+Env::Env(Platform* platform, Platform::StreamId stdin,
+         Platform::StreamId stdout, Platform::StreamId stderr,
+         const std::string& image) {
   assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
 
+  static const size_t HEAP_MBYTES = 64;
+  static const size_t HEAP_MAX_MBYTES = 1024;
+
   platform_ = platform;
-  heap_ = std::make_unique<Heap>();
-  mu_ = Namespace(String(this, "mu").tag_, Type::NIL).Evict(this);
+  heap_ = std::make_unique<Heap>(
+      HeapPages(platform, "H", HEAP_MBYTES),
+      HeapPages(platform, "M", HEAP_MAX_MBYTES),
+      platform->IsFound(platform->Find("T")));
   frame_id_ = 0;
-  namespace_ = mu_;
-  namespaces_["mu"] = mu_;
+  ns_epoch_ = 0;
+  args_ = std::make_unique<Tag[]>(ARGS_MAX);
+  argp_ = 0;
   nil_ = Type::NIL;
   src_form_ = Type::NIL;
+  compact_ = false;
+  gc_pending_ = false;
+  nogc_ = 0;
+  marking_ = false;
+  slice_usecs_ = 0;
+  slice_bytes_ = 0;
+  mark_threads_ = 1;
+  bad_image_ = false;
+
+  /* an image has the namespaces, only the standard streams are new. one
+   * that can't be loaded leaves the env unusable, the caller reports it */
+  if (!image.empty()) {
+    bad_image_ = !LoadImage(this, image);
+    if (!bad_image_) {
+      (void)Symbol::Bind(this, standard_input_, Stream(stdin).Evict(this));
+      (void)Symbol::Bind(this, standard_output_, Stream(stdout).Evict(this));
+      (void)Symbol::Bind(this, standard_error_, Stream(stderr).Evict(this));
+    }
+
+    return;
+  }
+
+  mu_ = Namespace::Make(this, String(this, "mu").tag_, Type::NIL);
+  namespace_ = mu_;
+  namespaces_["mu"] = mu_;
 
   standard_input_ =
       Namespace::Intern(this, mu_, String(this, "standard-input").tag_,
@@ -355,12 +1130,12 @@ Env::Env(Platform* platform, Platform::StreamId stdin,
 
   for (auto& el : kExtFuncTab) {
     auto sym = Namespace::Intern(this, mu_, String(this, el.name).tag_);
-    (void)Symbol::Bind(sym, Function(this, sym, &el).Evict(this));
+    (void)Symbol::Bind(this, sym, Function(this, sym, &el).Evict(this));
   }
 
   for (auto& el : kIntFuncTab) {
     auto sym = Namespace::InternInNs(this, mu_, String(this, el.name).tag_);
-    (void)Symbol::Bind(sym, Function(this, sym, &el).Evict(this));
+    (void)Symbol::Bind(this, sym, Function(this, sym, &el).Evict(this));
   }
 }
 
@@ -16,7 +16,7 @@
 
 #include <cassert>
 #include <memory>
-#include <stack>
+#include <unordered_set>
 
 #include "libmu/platform/platform.h"
 
@@ -42,7 +42,15 @@ class Env {
   /** * allocate from heap **/
   template <typename T>
   auto heap_alloc(size_t len, SYS_CLASS tag) -> T* {
-    return reinterpret_cast<T*>(heap_->Alloc(len, tag));
+    if (marking_ && (slice_bytes_ += len) >= SLICE_BYTES) GcSlice(this);
+
+    if (len >= heap::Heap::LARGE_BYTES)
+      return reinterpret_cast<T*>(AllocLarge(this, len, tag));
+
+    auto caddr = heap_->Alloc(len, tag);
+    if (caddr == nullptr) caddr = HeapExhausted(this, len, tag);
+
+    return reinterpret_cast<T*>(caddr);
   }
 
  public:
@@ -54,7 +62,8 @@ class Env {
           func(func),
           argv(argv),
           nargs(nargs),
-          value(Type::NIL) {}
+          value(Type::NIL),
+          link(nullptr) {}
 
     ~frame() {}
 
@@ -64,9 +73,55 @@ class Env {
     Tag* argv;    /* argument list */
     size_t nargs; /* length of argument list */
     Tag value;    /* return value */
+    frame* link;  /* lexically enclosing frame */
 
   } Frame;
 
+  /** * tag held on the C++ stack, a collector root while in scope **/
+  typedef struct root {
+    root(Env* env, Tag tag) : env(env) { env->roots_.push_back(tag); }
+    ~root() { env->roots_.pop_back(); }
+
+    Env* env; /* environment */
+  } Root;
+
+  /** * root stack mark, popped back to when it goes out of scope **/
+  /* builders that call functions hold their results here */
+  typedef struct rootmark {
+    explicit rootmark(Env* env) : env(env), base(env->roots_.size()) {}
+    ~rootmark() { env->roots_.resize(base); }
+
+    auto push(Tag tag) -> void { env->roots_.push_back(tag); }
+    auto roots() -> std::vector<Tag> {
+      return std::vector<Tag>(env->roots_.begin() + base, env->roots_.end());
+    }
+
+    Env* env;    /* environment */
+    size_t base; /* stack top when marked */
+  } RootMark;
+
+  /** * hold off collection while in scope **/
+  /* for callers that can't root what they hold across a call, the
+   * collections asked for meanwhile run at the next gc point after */
+  typedef struct nogc {
+    explicit nogc(Env* env) : env(env) { env->nogc_++; }
+    ~nogc() { env->nogc_--; }
+
+    Env* env; /* environment */
+  } NoGc;
+
+  /** * argument stack mark, popped back to when it goes out of scope **/
+  typedef struct argmark {
+    explicit argmark(Env* env) : env(env), base(env->argp_) {}
+    ~argmark() { env->argp_ = base; }
+
+    auto argv() -> Tag* { return &env->args_[base]; }
+    auto nargs() -> size_t { return env->argp_ - base; }
+
+    Env* env;    /* environment */
+    size_t base; /* stack top when marked */
+  } ArgMark;
+
  public:
   /** * mu core function implementation **/
   typedef std::function<void(Frame*)> FrameFn;
@@ -79,18 +134,24 @@ class Env {
   } TagFn;
 
   /** * map address to core function **/
-  auto CoreFunction(Tag caddr) -> TagFn* { return Type::Untag<TagFn>(caddr); }
-
- private:
-  std::unordered_map<Tag, std::stack<Frame*>> framecache_;
+  /* functions hold the address as a fixnum */
+  auto CoreFunction(Tag caddr) -> TagFn* {
+    return reinterpret_cast<TagFn*>(Fixnum::Uint64Of(caddr));
+  }
 
  public:
   std::map<std::string, Tag> namespaces_;
   std::unique_ptr<heap::Heap> heap_; /* heap */
   Platform* platform_;               /* platform */
   std::vector<Frame*> frames_;       /* frame stack */
-  size_t frame_id_;                  /* frame cache */
+  size_t frame_id_;                  /* function ids */
+  size_t ns_epoch_;                  /* namespace externs added */
   std::vector<Tag> lexenv_;          /* lexical symbols */
+  std::vector<Tag> roots_;           /* tags held on the C++ stack */
+  std::unique_ptr<Tag[]> args_;      /* argument stack */
+  size_t argp_;                      /* argument stack top */
+                                     /* remembered context frames */
+  std::unordered_set<Frame*> remembered_;
                                      /* syntax dispatch */
   std::unordered_map<Tag, Tag> readtable_;
   Tag mu_;              /* mu namespace */
@@ -100,28 +161,80 @@ class Env {
   Tag standard_input_;  /* standard input */
   Tag standard_output_; /* standard output */
   Tag standard_error_;  /* standard error */
+  bool compact_;        /* compact heap at next safe point */
+  bool gc_pending_;     /* collect at next gc point */
+  size_t nogc_;         /* collection held off */
+  std::string image_;   /* save heap image at next safe point */
+  bool bad_image_;      /* the image asked for couldn't be loaded */
+
+  /** * incremental marking **/
+  static const size_t SLICE_BYTES = 64 * 1024;
+  bool marking_;          /* mark cycle in progress */
+  uint64_t slice_usecs_;  /* slice budget, 0 is stop the world */
+  size_t slice_bytes_;    /* allocated since the last slice */
+  std::vector<Tag> gray_; /* queued for marking */
+  size_t mark_threads_;   /* stop the world mark threads */
+
+ public: /* argument stack */
+  /* frames are built over the arguments in place, it doesn't grow */
+  static const size_t ARGS_MAX = 64 * 1024;
+
+  auto PushArg(Tag arg) -> void {
+    if (argp_ == ARGS_MAX) ArgsExhausted(this);
+    args_[argp_++] = arg;
+  }
+
+  static auto ArgsExhausted(Env*) -> void;
 
  public: /* frame stack */
   constexpr auto PushFrame(Frame* fp) -> void { frames_.push_back(fp); }
   constexpr auto PopFrame() -> void { frames_.pop_back(); }
-  constexpr auto Cache(Frame* fp) -> void {
-    framecache_[fp->frame_id].push(fp);
-  }
-  constexpr auto UnCache(Frame* fp) -> void { framecache_[fp->frame_id].pop(); }
 
-  /** * map id to frame **/
-  constexpr auto MapFrame(Tag id) -> Frame* {
-    assert(!framecache_[id].empty());
-    return framecache_[id].top();
-  }
+  /** * innermost active frame of a function **/
+  static auto FindFrame(Env*, Tag) -> Frame*;
 
   static auto LastFrame(Env*) -> Tag;
 
  public: /* heap */
   static auto Gc(Env*) -> size_t;
+  static auto GcMinor(Env*) -> size_t;
   static auto GcFrame(Frame*) -> void;
   static auto GcMark(Env*, Tag) -> void;
 
+  static auto GcStart(Env*) -> void;
+  static auto GcSlice(Env*) -> void;
+  static auto GcFinish(Env*) -> size_t;
+
+  /** * run a pending or due collection at a call **/
+  /* callers of Funcall root the tags they hold or hold off collection */
+  static auto GcPoint(Env* env) -> void {
+    if ((env->gc_pending_ || env->heap_->due()) && env->nogc_ == 0)
+      GcPending(env);
+  }
+
+  static auto GcPending(Env*) -> void;
+  static auto Compact(Env*, Tag) -> Tag;
+  static auto SafePoint(Env*, Tag) -> Tag;
+  static auto SaveImage(Env*, const std::string&) -> bool;
+  static auto LoadImage(Env*, const std::string&) -> bool;
+  static auto Clone(Env*) -> Env*;
+  static auto HeapExhausted(Env*, size_t, SYS_CLASS) -> void*;
+  static auto AllocLarge(Env*, size_t, SYS_CLASS) -> void*;
+  static auto GcRelocate(Env*, Tag) -> void;
+  static auto ForwardFrame(Frame*) -> void;
+
+  /** * forwarding address of heap object during compaction **/
+  static auto Forward(Env* env, Tag ptr) -> Tag {
+    return (Type::IsImmediate(ptr) || Fixnum::IsType(ptr) ||
+            !env->heap_->in_from(reinterpret_cast<void*>(ptr)))
+               ? ptr
+               : Type::Entag(env->heap_->Forward(Type::Untag<void>(ptr)),
+                             Type::TagOf(ptr));
+  }
+
+  static auto WriteBarrier(Env*, Tag, Tag, Tag) -> void;
+  static auto WriteBarrier(Env*, Frame*, Tag, Tag) -> void;
+
   static auto Evict(Env*, Tag) -> Tag;
 
   static auto EnvStack(Env*) -> Tag;
@@ -138,7 +251,13 @@ class Env {
 
   static auto IsEvicted(Env* env, Tag ptr) -> bool {
     return Type::IsImmediate(ptr) || Fixnum::IsType(ptr) ||
-           env->heap_->in_heap(reinterpret_cast<void*>(ptr));
+           env->heap_->in_heap(reinterpret_cast<void*>(ptr)) ||
+           env->heap_->is_large(reinterpret_cast<void*>(ptr));
+  }
+
+  static auto IsYoung(Env* env, Tag ptr) -> bool {
+    return !Type::IsImmediate(ptr) && !Fixnum::IsType(ptr) &&
+           env->heap_->is_young(reinterpret_cast<void*>(ptr));
   }
 
   static auto ViewOf(Env*, Tag) -> Tag;
@@ -146,6 +265,8 @@ class Env {
  public: /* object */
   explicit Env(Platform*, Platform::StreamId, Platform::StreamId,
                Platform::StreamId);
+  explicit Env(Platform*, Platform::StreamId, Platform::StreamId,
+               Platform::StreamId, const std::string&);
 
 }; /* class Env */
 
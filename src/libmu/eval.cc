@@ -39,16 +39,111 @@
 
 namespace libmu {
 namespace core {
+namespace {
+
+const Tag kLet = Symbol::Keyword("let");
+const Tag kLetq = Symbol::Keyword("letq");
+const Tag kLexRef = Symbol::Keyword("lexref");
+
+/** * frame of a lexical reference, depth links up the static chain **/
+auto LexFrame(Env* env, Tag ref) -> Frame* {
+  assert(!env->frames_.empty());
+
+  auto fp = env->frames_.back();
+  for (auto depth = Fixnum::Uint64Of(Cons::car(ref)); depth; --depth) {
+    fp = fp->link;
+    if (fp == nullptr)
+      Condition::Raise(env, Condition::CONDITION_CLASS::CONTROL_ERROR,
+                       "lexical reference: no enclosing frame (eval)", ref);
+  }
+
+  return fp;
+}
+
+} /* anonymous namespace */
 
 /** * apply function to argument list **/
 auto Apply(Env* env, Tag fn, Tag args) -> Tag {
   assert(Function::IsType(fn));
   assert(Cons::IsList(args));
 
-  std::vector<Tag> argv;
-  Cons::ListToVec(args, argv);
+  Env::ArgMark mark(env);
+
+  Cons::cons_iter<Tag> iter(args);
+  for (auto it = iter.begin(); it != iter.end(); it = ++iter)
+    env->PushArg(it->car);
+
+  return Function::Funcall(env, fn, mark.argv(), mark.nargs());
+}
+
+/** * evaluate call form, its head already evaluated **/
+auto EvalCall(Env* env, Tag fn, Tag form) -> Tag {
+  Tag rval;
+
+  switch (Type::TypeOf(fn)) { /* keyword, should be :quote, :t, or :nil */
+    case SYS_CLASS::SYMBOL:
+      if (Type::Eq(fn, Symbol::Keyword("quote")))
+        rval = Cons::Nth(form, 1);
+      else if (Type::Eq(fn, Symbol::Keyword("t")))
+        rval = Eval(env, Cons::Nth(form, 1));
+      else if (Type::Eq(fn, Symbol::Keyword("nil")))
+        rval = Eval(env, Cons::Nth(form, 2));
+      else if (Type::Eq(fn, kLetq)) { /* (:letq (:lexref ...) expr) */
+        auto ref = Cons::cdr(Cons::Nth(form, 1));
+        auto value = Eval(env, Cons::Nth(form, 2));
+        auto fp = LexFrame(env, ref);
+        auto slot = &fp->argv[Fixnum::Uint64Of(Cons::cdr(ref))];
+
+        Env::WriteBarrier(env, fp, *slot, value);
+        rval = *slot = value;
+      } else if (Type::Eq(fn, kLet)) { /* (:let base (form...) . body) */
+        if (env->frames_.empty())
+          Condition::Raise(env, Condition::CONDITION_CLASS::CONTROL_ERROR,
+                           ":let: no enclosing frame (eval)", form);
+
+        auto fp = env->frames_.back();
+        auto base = Fixnum::Uint64Of(Cons::Nth(form, 1));
+        auto values = Cons::Nth(form, 2);
 
-  return Function::Funcall(env, fn, argv);
+        if (base + Cons::Length(env, values) > fp->nargs)
+          Condition::Raise(env, Condition::CONDITION_CLASS::PROGRAM_ERROR,
+                           ":let: base (eval)", form);
+
+        auto slot = &fp->argv[base];
+        Cons::cons_iter<Tag> iter(values);
+        for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
+          auto value = Eval(env, it->car);
+
+          Env::WriteBarrier(env, fp, *slot, value);
+          *slot++ = value;
+        }
+
+        rval = Type::NIL;
+        Cons::cons_iter<Tag> body(Cons::cdr(Cons::cdr(Cons::cdr(form))));
+        for (auto it = body.begin(); it != body.end(); it = ++body)
+          rval = Eval(env, it->car);
+      } else
+        Condition::Raise(env, Condition::CONDITION_CLASS::UNDEFINED_FUNCTION,
+                         "(eval)", fn);
+      break;
+    case SYS_CLASS::FUNCTION: { /* function object */
+      /* arguments are evaluated onto the argument stack, over the head */
+      Env::ArgMark mark(env);
+
+      env->PushArg(fn);
+      Cons::cons_iter<Tag> iter(Cons::cdr(form));
+      for (auto it = iter.begin(); it != iter.end(); it = ++iter)
+        env->PushArg(Eval(env, it->car));
+
+      rval = Function::Funcall(env, fn, mark.argv() + 1, mark.nargs() - 1);
+      break;
+    }
+    default:
+      Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR, "(eval)",
+                       fn);
+  }
+
+  return rval;
 }
 
 /** * evaluate form in environment **/
@@ -62,36 +157,16 @@ auto Eval(Env* env, Tag form) -> Tag {
                          "(eval)", form);
       rval = Symbol::value(form);
       break;
-    case SYS_CLASS::CONS: { /* function call */
-      auto fn = Eval(env, Cons::car(form));
-
-      switch (Type::TypeOf(fn)) { /* keyword, should be :quote, :t, or :nil */
-        case SYS_CLASS::SYMBOL:
-          if (Type::Eq(fn, Symbol::Keyword("quote")))
-            rval = Cons::Nth(form, 1);
-          else if (Type::Eq(fn, Symbol::Keyword("t")))
-            rval = Eval(env, Cons::Nth(form, 1));
-          else if (Type::Eq(fn, Symbol::Keyword("nil")))
-            rval = Eval(env, Cons::Nth(form, 2));
-          else
-            Condition::Raise(env,
-                             Condition::CONDITION_CLASS::UNDEFINED_FUNCTION,
-                             "(eval)", fn);
-          break;
-        case SYS_CLASS::FUNCTION: { /* function object */
-          std::vector<Tag> vlist;
-          Cons::cons_iter<Tag> iter(Cons::cdr(form));
-          for (auto it = iter.begin(); it != iter.end(); it = ++iter)
-            vlist.push_back({Eval(env, it->car)});
-          rval = Apply(env, fn, Cons::List(env, vlist));
-          break;
-        }
-        default:
-          Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR,
-                           "(eval)", fn);
+    case SYS_CLASS::CONS: /* function call */
+      if (Type::Eq(Cons::car(form), kLexRef)) {
+        auto ref = Cons::cdr(form);
+
+        rval = LexFrame(env, ref)->argv[Fixnum::Uint64Of(Cons::cdr(ref))];
+        break;
       }
+
+      rval = EvalCall(env, Eval(env, Cons::car(form)), form);
       break;
-    }
     default: /* constant */
       rval = form;
       break;
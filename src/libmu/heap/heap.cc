@@ -17,7 +17,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "libmu/platform/platform.h"
 
@@ -34,33 +36,110 @@ namespace heap {
 
 using SYS_CLASS = core::Type::SYS_CLASS;
 
+/** * thread an unreferenced object onto its free list **/
+auto Heap::FreeObject(HeapInfo* hp) -> void {
+  auto& head =
+      freelists_->at(FreeList(SysClass(*hp), SizeClass(Size(*hp) / 8)));
+  auto hi = reinterpret_cast<HeapInfo**>(hp);
+
+  *hp = RefBits(*hp, RefBits(*hp) & ~MARK_BITS);
+  hi[1] = head;
+  head = hp;
+
+  nfree_bytes_ += Size(*hp);
+  nfree_->at(static_cast<size_t>(SysClass(*hp)))++;
+}
+
 /** * find free object **/
 auto Heap::FindFree(size_t nbytes, SYS_CLASS tag) -> HeapInfo* {
-  if (nfree_->at(static_cast<size_t>(tag)) != 0) {
-    HeapInfo hinfo;
+  size_t nwords = 1 + (nbytes + 7) / 8;
+  size_t size_class = SizeClass(nwords);
 
-    if (tag == SYS_CLASS::CONS && conses_ != nullptr) {
-      auto cp = conses_;
-      auto hi = reinterpret_cast<HeapInfo**>(conses_);
+  if (nfree_->at(static_cast<size_t>(tag)) == 0) return nullptr;
 
-      *conses_ = RefBits(*conses_, 1);
-      conses_ = hi[1];
+  auto unlink = [this, tag](HeapInfo** link) {
+    auto hp = *link;
 
-      nfree_->at(static_cast<size_t>(tag))--;
-      return cp;
-    }
+    *link = reinterpret_cast<HeapInfo**>(hp)[1];
+    Mark(hp);
+    nfree_bytes_ -= Size(*hp);
+    nfree_->at(static_cast<size_t>(tag))--;
+
+    return hp;
+  };
 
-    for (auto hp = reinterpret_cast<uint64_t>(uaddr_);
-         hp < reinterpret_cast<uint64_t>(alloc_);
-         hp += Size(*reinterpret_cast<HeapInfo*>(hp))) {
-      hinfo = *reinterpret_cast<HeapInfo*>(hp);
-      /* install a size delta check here */
-      if (tag == SysClass(hinfo) && Size(hinfo) >= (nbytes + 8) &&
-          RefBits(hinfo) == 0) {
-        *reinterpret_cast<HeapInfo*>(hp) = RefBits(hinfo, 1);
-        nfree_->at(static_cast<size_t>(tag))--;
-        return reinterpret_cast<HeapInfo*>(hp);
+  /* exact sizes, any object on the list fits */
+  if (size_class < NEXACT_WORDS) {
+    auto& head = freelists_->at(FreeList(tag, size_class));
+
+    return (head == nullptr) ? nullptr : unlink(&head);
+  }
+
+  /* bucketed sizes, short first fit in our bucket */
+  auto link = &freelists_->at(FreeList(tag, size_class));
+  for (size_t nprobes = 0; *link != nullptr && nprobes < NFIRST_FIT;
+       ++nprobes, link = &reinterpret_cast<HeapInfo**>(*link)[1])
+    if (Size(**link) >= nwords * 8) return unlink(link);
+
+  /* anything in a larger bucket fits */
+  for (auto sc = size_class + 1; sc < NSIZE_CLASSES; ++sc) {
+    auto& head = freelists_->at(FreeList(tag, sc));
+
+    if (head != nullptr) return unlink(&head);
+  }
+
+  return nullptr;
+}
+
+/** * allocate from the front of a hole **/
+/* the rest of the hole stays on the free list, so it has to be big enough
+ * for a header and a link. */
+auto Heap::CarveHole(size_t nbytes, SYS_CLASS tag) -> HeapInfo* {
+  size_t nalloc = sizeof(HeapInfo) + ((nbytes + 7) & ~7);
+  size_t nhole = nalloc + 2 * sizeof(HeapInfo);
+  auto holes = static_cast<size_t>(SYS_CLASS::T);
+
+  if (nfree_->at(holes) == 0) return nullptr;
+
+  for (auto sc = SizeClass(nhole / 8); sc < NSIZE_CLASSES; ++sc) {
+    auto link = &freelists_->at(FreeList(SYS_CLASS::T, sc));
+
+    for (size_t nprobes = 0; *link != nullptr && nprobes < NFIRST_FIT;
+         ++nprobes, link = &reinterpret_cast<HeapInfo**>(*link)[1]) {
+      auto hp = *link;
+      auto size = Size(*hp);
+
+      if (size < nhole) continue;
+
+      *link = reinterpret_cast<HeapInfo**>(hp)[1];
+      nfree_bytes_ -= size;
+      nfree_->at(holes)--;
+
+      auto end = reinterpret_cast<char*>(hp) + size;
+      auto rest = reinterpret_cast<HeapInfo*>(reinterpret_cast<char*>(hp) +
+                                              nalloc);
+      *rest = MakeHeapInfo(size - nalloc, SYS_CLASS::T);
+
+      /* the front is in use again, the rest keeps any whole pages
+       * released */
+      if (RefBits(*hp) & RELEASED) {
+        auto nrest =
+            PageBytes(reinterpret_cast<char*>(rest) + 2 * sizeof(HeapInfo),
+                      end);
+        auto nbytes =
+            PageBytes(reinterpret_cast<char*>(hp) + 2 * sizeof(HeapInfo),
+                      end) -
+            nrest;
+
+        if (nrest) *rest = RefBits(*rest, RELEASED);
+        nreleased_bytes_ -= std::min(nreleased_bytes_, nbytes);
       }
+      FreeObject(rest);
+
+      *hp = MakeHeapInfo(nalloc, tag);
+      Mark(hp);
+
+      return hp;
     }
   }
 
@@ -71,26 +150,128 @@ auto Heap::FindFree(size_t nbytes, SYS_CLASS tag) -> HeapInfo* {
 auto Heap::Alloc(size_t nbytes, SYS_CLASS tag) -> void* {
   auto fp = FindFree(nbytes, tag);
 
+  /* sweep a little more before growing the heap */
+  for (size_t npages = 0;
+       fp == nullptr && sweep_ < sweep_end_ && npages < NSWEEP_PAGES;
+       ++npages) {
+    Sweep(1);
+    fp = FindFree(nbytes, tag);
+  }
+
+  if (fp == nullptr) fp = CarveHole(nbytes, tag);
+
   if (fp == nullptr) {
+    nmisses_->at(static_cast<size_t>(tag))++;
+
     char* halloc = alloc_;
     size_t nalloc = sizeof(HeapInfo) + ((nbytes + 7) & ~7);
 
-    alloc_ += nalloc;
+    /* out of committed pages, the caller decides whether to grow */
+    if (alloc_ + nalloc > uaddr_ + size()) return nullptr;
 
-    if (alloc_ > uaddr_ + (pagesz_ * npages_)) assert(!"heap capacity botch");
+    alloc_ += nalloc;
 
     *reinterpret_cast<HeapInfo*>(halloc) = MakeHeapInfo(nalloc, tag);
+    if (black_) Mark(reinterpret_cast<HeapInfo*>(halloc));
 
     nobjects_++;
     nalloc_->at(static_cast<size_t>(tag))++;
+    ndue_ -= std::min(ndue_, nalloc);
 
     return reinterpret_cast<void*>(halloc + sizeof(HeapInfo));
   } else {
+    /* recycled objects live below the nursery, their young refs have to be
+     * found by the next minor collection */
+    Remember(fp);
+    nhits_->at(static_cast<size_t>(tag))++;
+    ndue_ -= std::min(ndue_, Size(*fp));
     return reinterpret_cast<void*>(reinterpret_cast<char*>(fp) +
                                    sizeof(HeapInfo));
   }
 }
 
+/** * allocate large object **/
+/* in its own pages, the caller collects when enough of these pile up */
+auto Heap::AllocLarge(size_t nbytes, SYS_CLASS tag) -> void* {
+  auto nalloc = (sizeof(HeapInfo) + nbytes + pagesz_ - 1) / pagesz_ * pagesz_;
+  auto base = Platform::AllocPages(nalloc / pagesz_);
+
+  if (base == nullptr) return nullptr;
+
+  auto hp = reinterpret_cast<HeapInfo*>(base);
+
+  *hp = MakeHeapInfo(0, tag);
+  if (black_) Mark(hp);
+
+  large_->emplace(hp, nalloc);
+  nlarge_bytes_ += nalloc;
+  nlarge_alloc_ += nalloc;
+  nalloc_->at(static_cast<size_t>(tag))++;
+
+  return reinterpret_cast<void*>(hp + 1);
+}
+
+/** * unmap unmarked large objects **/
+auto Heap::FreeLarge() -> void {
+  for (auto large = large_->begin(); large != large_->end();) {
+    if (IsMarked(large->first)) {
+      ++large;
+      continue;
+    }
+
+    Platform::FreePages(reinterpret_cast<char*>(large->first),
+                        large->second / pagesz_);
+    nlarge_bytes_ -= large->second;
+    large = large_->erase(large);
+  }
+}
+
+/** * map function over large objects **/
+auto Heap::MapLarge(const std::function<void(HeapInfo*)>& fn) -> void {
+  for (auto& large : *large_) fn(large.first);
+}
+
+/** * commit more of the reserved heap **/
+/* at least NGROW_PAGES, or more if the request needs it, up to the limit.
+ * the reserve pages past the limit are only committed after UseReserve,
+ * to leave room for raising the exhaustion condition. */
+auto Heap::Grow(size_t nbytes) -> bool {
+  return Commit(nbytes, max_pages_ + (use_reserve_ ? NRESERVE_PAGES : 0));
+}
+
+/** * grow past the limit to reach the gc point of a due collection **/
+/* the pages stay committed. half the reserve is left for raising the
+ * exhaustion condition. */
+auto Heap::Bridge(size_t nbytes) -> bool {
+  return Commit(nbytes, max_pages_ + NRESERVE_PAGES / 2);
+}
+
+/** * commit pages for nbytes, up to limit pages **/
+auto Heap::Commit(size_t nbytes, size_t limit) -> bool {
+  auto need = npages_ + (nbytes + sizeof(HeapInfo) + pagesz_ - 1) / pagesz_;
+  auto npages = std::min(std::max(npages_ + NGROW_PAGES, need), limit);
+
+  if (npages < need) return false;
+
+  if (!Platform::CommitPages(uaddr_ + size(), npages - npages_, hugepages_))
+    return false;
+
+  npages_ = npages;
+  if (bitmap_ != nullptr) bitmap_->resize(size() / (8 * 64) + 1, 0);
+
+  return true;
+}
+
+/** * allocation until the next collection is due **/
+/* a collection falls due with NGROW_PAGES of free space left, so it runs
+ * at a gc point before the heap is exhausted and has to grow to get there.
+ * a heap with less than that free runs on half of what it has. */
+auto Heap::ResetDue() -> void {
+  auto headroom = NGROW_PAGES * pagesz_;
+
+  ndue_ = nfree() > headroom ? nfree() - headroom : nfree() / 2;
+}
+
 /** * count up total data bytes in heap **/
 auto Heap::room() -> size_t {
   size_t nbytes = 0;
@@ -121,64 +302,488 @@ auto Heap::room(SYS_CLASS tag) -> size_t {
   return total_size;
 }
 
-/** * clear refbits **/
-auto Heap::ClearRefBits() -> void {
-  HeapInfo hinfo;
+/** * clear mark bits **/
+/* the last cycle's marks are needed until its sweep is done. header marks
+ * are cleared by moving to the next epoch, without touching the heap. */
+auto Heap::ClearMarks() -> void {
+  FinishSweep();
 
-  for (auto hp = reinterpret_cast<uint64_t>(uaddr_);
-       hp < reinterpret_cast<uint64_t>(alloc_);
-       hp += Size(*reinterpret_cast<HeapInfo*>(hp))) {
-    hinfo = *reinterpret_cast<HeapInfo*>(hp);
-    *reinterpret_cast<HeapInfo*>(hp) = RefBits(hinfo, 0);
-  }
+  if (use_bitmap_) {
+    std::memset(bitmap_->data(), 0,
+                ((alloc_ - uaddr_) / (8 * 64) + 1) * sizeof(uint64_t));
+    MapLarge([this](HeapInfo* hp) { Unmark(hp); });
+  } else
+    mark_epoch_ = mark_epoch_ % MARK_BITS + 1;
 
-  for (auto& fp : *nfree_) fp = 0;
+  nmarked_bytes_ = 0;
+}
+
+/** * switch mark bits between the headers and the side bitmap **/
+/* old objects stay marked between collections, so the marks move too */
+auto Heap::UseBitmap(bool use_bitmap) -> void {
+  if (use_bitmap == use_bitmap_) return;
+
+  FinishSweep();
+
+  if (bitmap_ == nullptr)
+    bitmap_ = new std::vector<uint64_t>(size() / (8 * 64) + 1, 0);
+
+  std::vector<HeapInfo*> marked;
+
+  MapHeap([this, &marked](HeapInfo* hp) {
+    if (IsMarked(hp)) marked.push_back(hp);
+    *hp = RefBits(*hp, RefBits(*hp) & ~MARK_BITS);
+  });
+
+  std::fill(bitmap_->begin(), bitmap_->end(), 0);
+  use_bitmap_ = use_bitmap;
+
+  for (auto hp : marked) Mark(hp);
+}
+
+/** * add an old object to the remembered set **/
+auto Heap::Remember(HeapInfo* hp) -> void {
+  if (RefBits(*hp) & REMEMBERED) return;
+
+  *hp = RefBits(*hp, RefBits(*hp) | REMEMBERED);
+  remembered_->push_back(hp);
+}
+
+/** * empty the remembered set **/
+auto Heap::Forget() -> void {
+  for (auto hp : *remembered_)
+    *hp = RefBits(*hp, RefBits(*hp) & ~REMEMBERED);
+
+  remembered_->clear();
+}
+
+/** * record a collector pause **/
+auto Heap::Pause(uint64_t usecs) -> void {
+  pauses_->at(npauses_++ % NPAUSES) = usecs;
+  max_pause_ = std::max(max_pause_, usecs);
+}
+
+/** * 99th percentile of recent pauses **/
+auto Heap::PauseP99() -> uint64_t {
+  auto npauses = npauses_ < NPAUSES ? npauses_ : NPAUSES;
+
+  if (npauses == 0) return 0;
+
+  std::vector<uint64_t> pauses(pauses_->begin(), pauses_->begin() + npauses);
+  auto nth = pauses.begin() + (npauses * 99) / 100;
+
+  std::nth_element(pauses.begin(), nth, pauses.end());
+  return *nth;
 }
 
 /** * garbage collection **/
+/* marking is done. the free lists are rebuilt by a lazy sweep, driven by
+ * allocation and finished before the next cycle clears the marks. dead
+ * bytes not yet swept count as free. */
 auto Heap::Gc() -> size_t {
-  HeapInfo hinfo;
+  for (auto& fp : *freelists_) fp = nullptr;
+  for (auto& fp : *nfree_) fp = 0;
+  nfree_bytes_ = 0;
 
-  size_t nmarked = 0;
-  size_t nobjects = 0;
+  sweep_ = uaddr_;
+  sweep_end_ = alloc_;
+  nunswept_ = alloc() - std::min(nmarked_bytes_, alloc());
+
+  nobjects_ = 0;
+  young_ = alloc_;
+  use_reserve_ = false;
+  Forget();
+
+  FreeLarge();
+  nlarge_alloc_ = 0;
 
-  conses_ = nullptr;
+  /* collect first, grow second: double the heap when less than half of it
+   * is free */
+  if (nfree() < size() / 2) (void)Grow(size());
+  ResetDue();
+
+  return nfree();
+}
+
+/** * sweep dead objects onto the free lists **/
+auto Heap::Sweep(size_t npages) -> void {
+  for (size_t nbytes = 0; sweep_ < sweep_end_ && nbytes < npages * pagesz_;) {
+    auto hp = reinterpret_cast<HeapInfo*>(sweep_);
+    auto size = Size(*hp);
+
+    if (IsMarked(hp))
+      nobjects_++;
+    else
+      size = SweepRun(hp);
+
+    sweep_ += size;
+    nbytes += size;
+  }
+
+  if (sweep_ >= sweep_end_) nunswept_ = 0;
+}
+
+/** * free a run of dead objects, returns its length **/
+auto Heap::SweepRun(HeapInfo* hp) -> size_t {
+  auto start = reinterpret_cast<char*>(hp);
+  auto end = start;
+
+  while (end < sweep_end_ && !IsMarked(reinterpret_cast<HeapInfo*>(end)))
+    end += Size(*reinterpret_cast<HeapInfo*>(end));
+
+  size_t nbytes = end - start;
+  nunswept_ -= std::min(nunswept_, nbytes);
+
+  /* short runs go back on their own free lists */
+  auto page = reinterpret_cast<uintptr_t>(start) + 2 * sizeof(HeapInfo);
+  if ((page + 2 * pagesz_ - 1) / pagesz_ * pagesz_ >
+      reinterpret_cast<uintptr_t>(end)) {
+    for (auto fp = start; fp < end;) {
+      auto size = Size(*reinterpret_cast<HeapInfo*>(fp));
+
+      FreeObject(reinterpret_cast<HeapInfo*>(fp));
+      fp += size;
+    }
+
+    return nbytes;
+  }
+
+  auto align = [this](char* caddr, size_t round) {
+    return reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(caddr) + round) / pagesz_ * pagesz_);
+  };
+
+  for (auto hole = start; hole < end;) {
+    auto fp = hole;
+
+    while (fp < end && static_cast<size_t>(fp - hole) +
+                               Size(*reinterpret_cast<HeapInfo*>(fp)) <=
+                           MAX_HOLE_BYTES)
+      fp += Size(*reinterpret_cast<HeapInfo*>(fp));
+
+    /* holes swept again have their pages released already, only the
+     * pages between them go back. that can take a hole's header with it,
+     * so sizes are read first. */
+    auto from = hole + 2 * sizeof(HeapInfo);
+    auto released = false;
+
+    for (auto op = hole; op < fp;) {
+      auto hinfo = *reinterpret_cast<HeapInfo*>(op);
+
+      if (RefBits(hinfo) & RELEASED) {
+        nreleased_bytes_ += Release(from, align(op + 2 * sizeof(HeapInfo),
+                                                pagesz_ - 1));
+        from = align(op + Size(hinfo), 0);
+        released = true;
+      }
+
+      op += Size(hinfo);
+    }
+
+    auto nfresh = Release(from, fp);
+
+    nreleased_bytes_ += nfresh;
+    *reinterpret_cast<HeapInfo*>(hole) = MakeHeapInfo(fp - hole, SYS_CLASS::T);
+    if (released || nfresh)
+      *reinterpret_cast<HeapInfo*>(hole) =
+          RefBits(*reinterpret_cast<HeapInfo*>(hole), RELEASED);
+    FreeObject(reinterpret_cast<HeapInfo*>(hole));
+
+    hole = fp;
+  }
+
+  return nbytes;
+}
+
+/** * bytes in the whole pages of a range **/
+auto Heap::PageBytes(char* from, char* to) -> size_t {
+  auto lo = (reinterpret_cast<uintptr_t>(from) + pagesz_ - 1) / pagesz_;
+  auto hi = reinterpret_cast<uintptr_t>(to) / pagesz_;
+
+  return lo < hi ? (hi - lo) * pagesz_ : 0;
+}
+
+/** * give the whole pages in a range back to the system **/
+/* returns the bytes given back, the caller counts them */
+auto Heap::Release(char* from, char* to) -> size_t {
+  auto nbytes = PageBytes(from, to);
+
+  if (release_ == RELEASE::NONE || nbytes == 0) return 0;
+
+  auto lo = (reinterpret_cast<uintptr_t>(from) + pagesz_ - 1) / pagesz_;
+  if (!Platform::ReleasePages(reinterpret_cast<char*>(lo * pagesz_),
+                              nbytes / pagesz_, release_ == RELEASE::FREE))
+    return 0;
+
+  nreleases_++;
+  return nbytes;
+}
+
+/** * bytes given back, in holes and above the allocation barrier **/
+/* bumping past the barrier uses the pages above it again */
+auto Heap::released() -> size_t {
+  return nreleased_bytes_ + PageBytes(alloc_, release_end_);
+}
+
+/** * resident bytes in the committed heap **/
+auto Heap::resident() -> size_t {
+  return Platform::ResidentPages(uaddr_, npages_) * pagesz_;
+}
+
+/** * nursery collection **/
+/* survivors are promoted in place, the nursery barrier moves up to alloc_ */
+auto Heap::GcMinor() -> size_t {
+  for (auto hp = reinterpret_cast<uint64_t>(young_);
+       hp < reinterpret_cast<uint64_t>(alloc_);
+       hp += Size(*reinterpret_cast<HeapInfo*>(hp))) {
+    if (!IsMarked(reinterpret_cast<HeapInfo*>(hp))) {
+      FreeObject(reinterpret_cast<HeapInfo*>(hp));
+      nobjects_--;
+    }
+  }
+
+  young_ = alloc_;
+  Forget();
+
+  /* old large objects stay marked, only dead young ones are unmarked */
+  FreeLarge();
+  ResetDue();
+
+  return nfree();
+}
+
+/** * map function over heap objects **/
+auto Heap::MapHeap(const std::function<void(HeapInfo*)>& fn) -> void {
+  for (auto hp = reinterpret_cast<uint64_t>(uaddr_);
+       hp < reinterpret_cast<uint64_t>(alloc_);
+       hp += Size(*reinterpret_cast<HeapInfo*>(hp)))
+    fn(reinterpret_cast<HeapInfo*>(hp));
+}
+
+/** * compute forwarding addresses for marked objects **/
+auto Heap::Relocate() -> void {
+  HeapInfo hinfo;
+  uint64_t reloc = 0;
 
-  /* count the ref bits */
   for (auto hp = reinterpret_cast<uint64_t>(uaddr_);
        hp < reinterpret_cast<uint64_t>(alloc_);
        hp += Size(*reinterpret_cast<HeapInfo*>(hp))) {
     hinfo = *reinterpret_cast<HeapInfo*>(hp);
-    if (RefBits(hinfo) == 0) {
-      nfree_->at(static_cast<size_t>(SysClass(hinfo)))++;
-      if (SysClass(hinfo) == SYS_CLASS::CONS) {
-        auto hi = reinterpret_cast<HeapInfo**>(hp);
+    if (IsMarked(reinterpret_cast<HeapInfo*>(hp))) {
+      *reinterpret_cast<HeapInfo*>(hp) = Reloc(hinfo, reloc);
+      reloc += Size(hinfo);
+    }
+  }
+}
 
-        hi[1] = conses_;
-        conses_ = reinterpret_cast<HeapInfo*>(hp);
-      }
-    } else {
+/** * slide marked objects to their forwarding addresses **/
+/* the mutator has fixed up its tags from Forward by now */
+auto Heap::Compact() -> size_t {
+  HeapInfo hinfo;
+  char* to = uaddr_;
+  size_t nobjects = 0;
+
+  Forget();
+
+  for (auto hp = uaddr_; hp < alloc_; hp += Size(hinfo)) {
+    hinfo = *reinterpret_cast<HeapInfo*>(hp);
+    if (IsMarked(reinterpret_cast<HeapInfo*>(hp))) {
+      to = uaddr_ + Reloc(hinfo);
+      std::memmove(to, hp, Size(hinfo));
+      *reinterpret_cast<HeapInfo*>(to) =
+          Reloc(RefBits(hinfo, mark_epoch_), 0);
+      to += Size(hinfo);
       nobjects++;
-      nmarked += Size(hinfo) + sizeof(HeapInfo);
     }
   }
 
+  for (auto& fp : *freelists_) fp = nullptr;
+  for (auto& fp : *nfree_) fp = 0;
+
+  /* the holes are gone, the pages freed above the live objects go back */
+  nreleased_bytes_ = 0;
+  release_end_ = Release(to, alloc_) ? alloc_ : uaddr_;
+  FreeLarge();
+
+  /* everything left is live, and marked for the next minor collection */
+  if (use_bitmap_) ClearMarks();
+  alloc_ = to;
+  if (use_bitmap_) {
+    MapHeap([this](HeapInfo* hp) { Mark(hp); });
+    MapLarge([this](HeapInfo* hp) { Mark(hp); });
+  }
+
+  nfree_bytes_ = 0;
   nobjects_ = nobjects;
-  return (pagesz_ * npages_) - nmarked;
+  young_ = alloc_;
+  sweep_ = sweep_end_ = alloc_;
+  nunswept_ = 0;
+  ResetDue();
+
+  return nfree();
 }
 
-/** * heap object **/
-Heap::Heap() {
-  const char* heapId = "heap";
+/** * write heap image **/
+/* header words, the caller's words, the address and size of each live
+ * large object, then the heap from a page boundary and the large objects
+ * after it. */
+auto Heap::SaveImage(const std::string& path,
+                     const std::vector<uint64_t>& words) -> bool {
+  std::vector<std::pair<HeapInfo*, size_t>> large;
+
+  for (auto& entry : *large_)
+    if (IsMarked(entry.first)) large.push_back(entry);
+
+  auto header = std::vector<uint64_t>{
+      IMAGE_MAGIC, IMAGE_VERSION, reinterpret_cast<uint64_t>(uaddr_),
+      alloc(),     mark_epoch_,   words.size(),
+      large.size()};
+
+  header.insert(header.end(), words.begin(), words.end());
+  for (auto& entry : large) {
+    header.push_back(reinterpret_cast<uint64_t>(entry.first));
+    header.push_back(entry.second);
+  }
 
-  pagesz_ = 4096;
-  npages_ = 1024 * 16;
+  auto offset = (header.size() * sizeof(uint64_t) + pagesz_ - 1) / pagesz_;
+  auto npages = (alloc() + pagesz_ - 1) / pagesz_;
+
+  header.resize(offset * pagesz_ / sizeof(uint64_t), 0);
+
+  auto fp = std::fopen(path.c_str(), "w");
+  if (fp == nullptr) return false;
+
+  /* whole pages, the mapping can't run past the end of the file */
+  auto nwords = std::fwrite(header.data(), sizeof(uint64_t), header.size(), fp);
+  auto ok = nwords == header.size() &&
+            std::fwrite(uaddr_, pagesz_, npages, fp) == npages;
+
+  for (auto& entry : large)
+    ok = ok && std::fwrite(entry.first, pagesz_, entry.second / pagesz_, fp) ==
+                   entry.second / pagesz_;
+
+  return std::fclose(fp) == 0 && ok;
+}
+
+/** * map heap image **/
+/* words are the caller's header words. the heap is rebasing when this
+ * returns if the image was saved at another address. */
+auto Heap::LoadImage(const std::string& path, std::vector<uint64_t>* words)
+    -> bool {
+  static const size_t NHEADER = 7;
+  uint64_t header[NHEADER];
+  std::vector<uint64_t> large;
+
+  auto fp = std::fopen(path.c_str(), "r");
+  if (fp == nullptr) return false;
+
+  auto ok = std::fread(header, sizeof(uint64_t), NHEADER, fp) == NHEADER &&
+            header[0] == IMAGE_MAGIC && header[1] == IMAGE_VERSION &&
+            header[3] <= max_size() && alloc() == 0;
+
+  if (ok) {
+    words->resize(header[5]);
+    large.resize(2 * header[6]);
+    ok = std::fread(words->data(), sizeof(uint64_t), words->size(), fp) ==
+             words->size() &&
+         std::fread(large.data(), sizeof(uint64_t), large.size(), fp) ==
+             large.size();
+  }
+
+  std::fclose(fp);
+  if (!ok) return false;
+
+  auto nbytes = header[3];
+  auto offset = ((NHEADER + words->size() + large.size()) * sizeof(uint64_t) +
+                 pagesz_ - 1) /
+                pagesz_ * pagesz_;
+
+  if (nbytes > size() && !Grow(nbytes - size())) return false;
+
+  if (nbytes &&
+      !Platform::MapFile(path.c_str(), offset, uaddr_,
+                         (nbytes + pagesz_ - 1) / pagesz_))
+    assert(!"heap image map botch");
+
+  /* large objects land wherever the system puts them */
+  offset += (nbytes + pagesz_ - 1) / pagesz_ * pagesz_;
+  for (size_t i = 0; i < large.size(); i += 2) {
+    auto nlarge = large[i + 1];
+    auto base = Platform::AllocPages(nlarge / pagesz_);
+
+    if (base == nullptr ||
+        !Platform::MapFile(path.c_str(), offset, base, nlarge / pagesz_))
+      assert(!"heap image large object botch");
+
+    large_->emplace(reinterpret_cast<HeapInfo*>(base), nlarge);
+    large_from_->emplace(reinterpret_cast<char*>(large[i]),
+                         std::make_pair(base, nlarge));
+    nlarge_bytes_ += nlarge;
+    offset += nlarge;
+  }
+
+  from_ = reinterpret_cast<char*>(header[2]);
+  mark_epoch_ = static_cast<uint8_t>(header[4]);
+  alloc_ = young_ = sweep_end_ = uaddr_ + nbytes;
+
+  /* unmarked objects in the image are free, the sweep finds them */
+  sweep_ = uaddr_;
+  nunswept_ = 0;
+  nobjects_ = 0;
+  ResetDue();
+
+  return true;
+}
+
+/** * heap object **/
+/* the whole range up to the limit is reserved now and committed as the
+ * heap grows, so objects never move when it does. */
+Heap::Heap(size_t npages, size_t max_pages, bool hugepages) {
+  pagesz_ = Platform::PAGESIZE;
+  max_pages_ = std::max(npages, max_pages);
+  npages_ = npages;
+  hugepages_ = hugepages;
+  use_reserve_ = false;
+
+  uaddr_ = Platform::ReservePages(max_pages_ + NRESERVE_PAGES);
+  if (uaddr_ == nullptr) assert(!"heap reserve botch");
+  from_ = uaddr_;
+
+  if (!Platform::CommitPages(uaddr_, npages_, hugepages_))
+    assert(!"heap commit botch");
 
-  uaddr_ = const_cast<char*>(Platform::MapPages(npages_, heapId));
   alloc_ = uaddr_;
-  conses_ = nullptr;
+  young_ = uaddr_;
+  nobjects_ = 0;
+  nfree_bytes_ = 0;
+  nmarked_bytes_ = 0;
+  use_bitmap_ = false;
+  bitmap_ = nullptr;
+  mark_epoch_ = 1;
+  sweep_ = sweep_end_ = uaddr_;
+  nunswept_ = 0;
+  ResetDue();
+  freelists_ = new std::vector<HeapInfo*>(NSYS_CLASSES * NSIZE_CLASSES,
+                                          nullptr);
+  large_ = new std::unordered_map<HeapInfo*, size_t>();
+  large_from_ = new std::map<char*, std::pair<char*, size_t>>();
+  nlarge_bytes_ = 0;
+  nlarge_alloc_ = 0;
   nfree_ = new std::vector<uint32_t>(256, 0);
   nalloc_ = new std::vector<uint32_t>(256, 0);
+  nhits_ = new std::vector<uint32_t>(256, 0);
+  nmisses_ = new std::vector<uint32_t>(256, 0);
+  remembered_ = new std::vector<HeapInfo*>();
+  minor_ = major_ = GcStats{0, 0, 0};
+  black_ = false;
+  pauses_ = new std::vector<uint64_t>(NPAUSES, 0);
+  npauses_ = 0;
+  max_pause_ = 0;
+  max_finish_ = 0;
+  release_ = RELEASE::DONTNEED;
+  nreleased_bytes_ = 0;
+  nreleases_ = 0;
+  release_end_ = uaddr_;
   filename_ = "";
 }
 
@@ -18,10 +18,14 @@
 #include <cassert>
 #include <cinttypes>
 #include <cstdio>
+#include <functional>
 #include <iostream>
 #include <list>
+#include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "libmu/platform/platform.h"
 
@@ -59,10 +63,53 @@ class Heap {
  private:
   std::string filename_; /* mapped file */
   size_t pagesz_;        /* page size for this heap */
-  size_t npages_;        /* number of pages in the heap */
+  size_t npages_;        /* number of committed pages */
+  size_t max_pages_;     /* committed page limit */
+  bool hugepages_;       /* advise transparent huge pages */
+  bool use_reserve_;     /* may commit the reserve pages */
   char* uaddr_;          /* user virtual address */
+  char* from_;           /* forwarding from, uaddr_ but while rebasing */
   char* alloc_;          /* alloc barrier */
-  HeapInfo* conses_;     /* gc caching */
+  char* young_;          /* nursery barrier */
+  size_t nfree_bytes_;   /* bytes on the free lists */
+  bool use_bitmap_;      /* mark in bitmap_, not the headers */
+  uint8_t mark_epoch_;   /* header mark value this cycle, 1 to 3 */
+  char* sweep_;          /* lazy sweep cursor */
+  char* sweep_end_;      /* end of lazy sweep */
+  size_t nunswept_;      /* dead bytes not yet swept */
+  size_t ndue_;          /* bytes to allocate until a collection is due */
+
+  std::vector<uint64_t>* bitmap_; /* side mark bits, one per heap word */
+
+  std::vector<HeapInfo*>* freelists_; /* free lists by class and size */
+
+  /* large objects being rebased, by image address */
+  std::map<char*, std::pair<char*, size_t>>* large_from_;
+
+ public:
+  /** * free list size classes **/
+  /* exact word counts below NEXACT_WORDS, then power of two buckets */
+  static const size_t NEXACT_WORDS = 64;
+  static const size_t NEXACT_LOG2 = 6;
+  static const size_t NSIZE_CLASSES = NEXACT_WORDS + 16 - NEXACT_LOG2;
+  static const size_t NSYS_CLASSES =
+      static_cast<size_t>(SYS_CLASS::VECTOR) + 1;
+  static const size_t NFIRST_FIT = 8;
+
+  /** * size class from object size in words **/
+  static constexpr size_t SizeClass(size_t nwords) {
+    size_t log2 = 0;
+
+    if (nwords < NEXACT_WORDS) return nwords;
+    while (nwords >>= 1) log2++;
+
+    return NEXACT_WORDS + log2 - NEXACT_LOG2;
+  }
+
+  /** * free list index from SYS_CLASS and size class **/
+  static constexpr size_t FreeList(SYS_CLASS tag, size_t size_class) {
+    return static_cast<size_t>(tag) * NSIZE_CLASSES + size_class;
+  }
 
  public:
   /** * SYS_CLASS from HeapInfo **/
@@ -110,18 +157,246 @@ class Heap {
   }
 
  public:
-  size_t nobjects_;               /* number of objects in the heap */
-  std::vector<uint32_t>* nalloc_; /* allocated counts */
-  std::vector<uint32_t>* nfree_;  /* free counts */
+  /** * ref bits **/
+  /* the low two bits hold the epoch an object was last marked in, 0 for
+   * never. advancing the epoch unmarks the whole heap. */
+  static const uint8_t MARK_BITS = 0x3;
+  static const uint8_t REMEMBERED = 0x4;
+  static const uint8_t RELEASED = 0x8; /* hole pages given back */
+
+  /** * pages swept looking for a free object before bumping **/
+  static const size_t NSWEEP_PAGES = 8;
+
+  /** * pages committed at a time to run on until a collection **/
+  static const size_t NGROW_PAGES = 16;
+
+  /** * pages reserved past the limit to report exhaustion in **/
+  static const size_t NRESERVE_PAGES = 256;
+
+  /** * free page runs **/
+  /* dead runs covering a whole page are swept into holes, T class free
+   * objects no larger than the size field allows. the pages inside a hole
+   * go back to the system under the release policy. */
+  static const size_t MAX_HOLE_BYTES = 0xffff * 8;
+
+  enum class RELEASE : uint8_t { NONE, DONTNEED, FREE };
+
+  /** * large object space **/
+  /* objects this size and up get their own page aligned mapping outside
+   * the heap. they have a zero size header, are always marked in it, never
+   * move, and are unmapped when found dead. */
+  static const size_t LARGE_BYTES = 32 * 1024;
+
+  /** * collection statistics **/
+  typedef struct {
+    size_t ncollections; /* number of collections */
+    uint64_t usecs;      /* total pause time, microseconds */
+    uint64_t last_usecs; /* most recent pause time */
+  } GcStats;
+
+ public:
+  size_t nobjects_;                /* number of objects in the heap */
+  size_t nmarked_bytes_;           /* bytes marked this cycle */
+  std::vector<uint32_t>* nalloc_;  /* allocated counts */
+  std::vector<uint32_t>* nfree_;   /* free counts */
+  std::vector<uint32_t>* nhits_;   /* free list hits */
+  std::vector<uint32_t>* nmisses_; /* free list misses */
+
+  std::vector<HeapInfo*>* remembered_; /* old objects with young refs */
+  GcStats minor_;                      /* nursery collections */
+  GcStats major_;                      /* full collections */
+  bool black_;                         /* allocate marked */
+
+  static const size_t NPAUSES = 1024;
+  std::vector<uint64_t>* pauses_; /* recent pause times, a ring */
+  size_t npauses_;                /* pauses recorded */
+  uint64_t max_pause_;            /* longest pause */
+  uint64_t max_finish_;           /* longest forced cycle finish */
+
+  std::unordered_map<HeapInfo*, size_t>* large_; /* large objects, sizes */
+  size_t nlarge_bytes_;                           /* mapped for large objects */
+  size_t nlarge_alloc_; /* large bytes since the last collection */
+
+  RELEASE release_;        /* free page policy */
+  size_t nreleased_bytes_; /* bytes given back in holes */
+  size_t nreleases_;       /* page runs given back */
+  char* release_end_;      /* end of pages given back above alloc_ */
 
   constexpr size_t size() { return pagesz_ * npages_; }
+  constexpr size_t max_size() { return pagesz_ * max_pages_; }
   constexpr size_t alloc() { return alloc_ - uaddr_; }
+  constexpr size_t nfree() {
+    return size() - alloc() + nfree_bytes_ + nunswept_;
+  }
 
   void* Alloc(size_t, SYS_CLASS);
+  void* AllocLarge(size_t, SYS_CLASS);
+  auto FreeLarge() -> void;
+  auto MapLarge(const std::function<void(HeapInfo*)>&) -> void;
+
+  /** * is this caddr a large object? **/
+  auto is_large(void* caddr) -> bool {
+    auto hp =
+        reinterpret_cast<HeapInfo*>(reinterpret_cast<uint64_t>(caddr) & ~7ULL) -
+        1;
+
+    return !large_->empty() && large_->count(hp) != 0;
+  }
+
+  auto Grow(size_t) -> bool;
+  auto Bridge(size_t) -> bool;
+  auto Commit(size_t, size_t) -> bool;
+  auto UseReserve() -> void { use_reserve_ = true; }
+  auto use_reserve() -> bool { return use_reserve_; }
+
+  auto ResetDue() -> void;
+  auto due() -> bool { return ndue_ == 0; }
 
   auto Gc() -> size_t;
-  auto ClearRefBits() -> void;
+  auto GcMinor() -> size_t;
+  auto Sweep(size_t) -> void;
+  auto SweepRun(HeapInfo*) -> size_t;
+  auto PageBytes(char*, char*) -> size_t;
+  auto Release(char*, char*) -> size_t;
+  auto released() -> size_t;
+  auto resident() -> size_t;
+  auto FinishSweep() -> void { Sweep((sweep_end_ - sweep_) / pagesz_ + 1); }
+  auto Remember(HeapInfo*) -> void;
+  auto Forget() -> void;
+  auto Pause(uint64_t) -> void;
+  auto PauseP99() -> uint64_t;
+
+  auto Relocate() -> void;
+  auto Compact() -> size_t;
+  auto MapHeap(const std::function<void(HeapInfo*)>&) -> void;
+
+  /** * heap images **/
+  /* an image is a compacted heap, mapped back copy on write. one mapped at
+   * another address is rebased, every address moves by the same amount. */
+  static const uint64_t IMAGE_MAGIC = 0x6567616d692d756d; /* mu-image */
+  static const uint64_t IMAGE_VERSION = 7;
+
+  auto SaveImage(const std::string&, const std::vector<uint64_t>&) -> bool;
+  auto LoadImage(const std::string&, std::vector<uint64_t>*) -> bool;
+  auto rebasing() -> bool {
+    return from_ != uaddr_ || !large_from_->empty();
+  }
+  auto Rebased() -> void {
+    from_ = uaddr_;
+    large_from_->clear();
+  }
+
+  /** * image large object holding caddr, or end **/
+  auto LargeFrom(void* caddr)
+      -> std::map<char*, std::pair<char*, size_t>>::iterator {
+    auto addr = reinterpret_cast<char*>(caddr);
+    auto large = large_from_->upper_bound(addr);
+
+    if (large == large_from_->begin()) return large_from_->end();
+    --large;
+
+    return addr < large->first + large->second.second ? large
+                                                      : large_from_->end();
+  }
+
+  /** * is this caddr in the space being forwarded from? **/
+  auto in_from(void* caddr) -> bool {
+    return ((uint64_t)caddr >= (uint64_t)from_ &&
+            (uint64_t)caddr < (uint64_t)from_ + alloc()) ||
+           (!large_from_->empty() && LargeFrom(caddr) != large_from_->end());
+  }
+
+  /** * forwarding address of a relocated object **/
+  auto Forward(void* caddr) -> void* {
+    auto addr = reinterpret_cast<char*>(caddr);
+
+    if (rebasing()) {
+      auto large = LargeFrom(caddr);
+
+      return large == large_from_->end()
+                 ? uaddr_ + (addr - from_)
+                 : large->second.first + (addr - large->first);
+    }
+
+    auto hp = reinterpret_cast<HeapInfo*>(caddr) - 1;
+
+    return uaddr_ + Reloc(*hp) + sizeof(HeapInfo);
+  }
+  /** * mark bits **/
+  /* either the object header ref bits or a bit per heap word in a side
+   * bitmap, which leaves the headers untouched by marking. */
+  auto MarkBit(HeapInfo* hp) -> size_t {
+    return (reinterpret_cast<char*>(hp) - uaddr_) / 8;
+  }
+
+  auto in_bitmap(HeapInfo* hp) -> bool { return use_bitmap_ && in_heap(hp); }
+
+  auto IsMarked(HeapInfo* hp) -> bool {
+    if (!in_bitmap(hp)) return (RefBits(*hp) & MARK_BITS) == mark_epoch_;
+
+    auto bit = MarkBit(hp);
+    return (bitmap_->data()[bit / 64] >> (bit % 64)) & 1;
+  }
+
+  /** * mark, false if already marked **/
+  auto TryMark(HeapInfo* hp) -> bool {
+    if (IsMarked(hp)) return false;
+
+    if (in_bitmap(hp)) {
+      auto bit = MarkBit(hp);
+      bitmap_->data()[bit / 64] |= 1ULL << (bit % 64);
+    } else
+      *hp = RefBits(*hp, (RefBits(*hp) & ~MARK_BITS) | mark_epoch_);
+
+    nmarked_bytes_ += Size(*hp);
+    return true;
+  }
+
+  /** * mark from more than one thread, false if already marked **/
+  /* marked bytes are the caller's to count */
+  auto TryMarkAtomic(HeapInfo* hp) -> bool {
+    if (in_bitmap(hp)) {
+      auto bit = MarkBit(hp);
+      auto mask = 1ULL << (bit % 64);
+
+      return (__atomic_fetch_or(&bitmap_->data()[bit / 64], mask,
+                                __ATOMIC_RELAXED) &
+              mask) == 0;
+    }
+
+    /* ref bits are the second byte of the little-endian header */
+    auto refbits = reinterpret_cast<uint8_t*>(hp) + 1;
+    auto bits = __atomic_load_n(refbits, __ATOMIC_RELAXED);
+
+    do {
+      if ((bits & MARK_BITS) == mark_epoch_) return false;
+    } while (!__atomic_compare_exchange_n(
+        refbits, &bits, static_cast<uint8_t>((bits & ~MARK_BITS) | mark_epoch_),
+        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return true;
+  }
+
+  auto Mark(HeapInfo* hp) -> void { (void)TryMark(hp); }
+
+  auto Unmark(HeapInfo* hp) -> void {
+    if (in_bitmap(hp)) {
+      auto bit = MarkBit(hp);
+      bitmap_->data()[bit / 64] &= ~(1ULL << (bit % 64));
+    } else
+      *hp = RefBits(*hp, 0);
+  }
+
+  auto AddMarked(size_t nbytes) -> void {
+    __atomic_fetch_add(&nmarked_bytes_, nbytes, __ATOMIC_RELAXED);
+  }
+
+  auto ClearMarks() -> void;
+  auto UseBitmap(bool) -> void;
+  auto use_bitmap() -> bool { return use_bitmap_; }
   auto FindFree(size_t, SYS_CLASS) -> HeapInfo*;
+  auto CarveHole(size_t, SYS_CLASS) -> HeapInfo*;
+  auto FreeObject(HeapInfo*) -> void;
 
   /** * is this cadder in the heap? **/
   auto in_heap(void* caddr) -> bool {
@@ -129,10 +404,23 @@ class Heap {
            (uint64_t)caddr < (uint64_t)uaddr_ + npages_ * pagesz_;
   }
 
+  /** * is this caddr in the nursery? **/
+  /* large objects are young until a collection finds them live */
+  auto is_young(void* caddr) -> bool {
+    if ((uint64_t)caddr >= (uint64_t)young_ &&
+        (uint64_t)caddr < (uint64_t)alloc_)
+      return true;
+
+    return !in_heap(caddr) && is_large(caddr) &&
+           !IsMarked(reinterpret_cast<HeapInfo*>(
+                         reinterpret_cast<uint64_t>(caddr) & ~7ULL) -
+                     1);
+  }
+
   size_t room();
   size_t room(SYS_CLASS);
 
-  explicit Heap();
+  explicit Heap(size_t, size_t, bool);
 };
 
 } /* namespace heap */
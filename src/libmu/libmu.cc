@@ -124,23 +124,49 @@ auto withCondition(void* env, const std::function<void(void*)>& fn) -> void {
 
 /** * eval **/
 auto eval(void* env, uintptr_t form) -> uintptr_t {
-  return static_cast<uintptr_t>(core::Eval(
-      (Env*)env, core::Compile((Env*)env, static_cast<Type::Tag>(form))));
+  auto ev = reinterpret_cast<Env*>(env);
+  Type::Tag value;
+
+  {
+    Env::Root src(ev, static_cast<Type::Tag>(form));
+    auto compiled = core::Compile(ev, static_cast<Type::Tag>(form));
+    Env::Root root(ev, compiled);
+
+    value = core::Eval(ev, compiled);
+  }
+
+  /* top level is the only point with no heap tags on the C++ stack */
+  value = Env::SafePoint(ev, value);
+
+  return static_cast<uintptr_t>(value);
 }
 
-/** * env - allocate an environment **/
+/** * env - allocate an environment, 0 if its -I image can't be loaded **/
 auto env_default(Platform* platform) -> uintptr_t {
   auto stdin = Platform::OpenStandardStream(Platform::STD_STREAM::STDIN);
   auto stdout = Platform::OpenStandardStream(Platform::STD_STREAM::STDOUT);
   auto stderr = Platform::OpenStandardStream(Platform::STD_STREAM::STDERR);
 
-  return (uintptr_t) new Env(platform, stdin, stdout, stderr);
+  return env(platform, stdin, stdout, stderr);
 }
 
-/** * env - allocate an environment **/
+/** * env - allocate an environment, 0 if its -I image can't be loaded **/
 auto env(Platform* platform, Platform::StreamId stdin,
          Platform::StreamId stdout, Platform::StreamId stderr) -> uintptr_t {
-  return (uintptr_t) new Env(platform, stdin, stdout, stderr);
+  auto ev = new Env(platform, stdin, stdout, stderr);
+
+  if (ev->bad_image_) {
+    delete ev;
+    return 0;
+  }
+
+  return (uintptr_t)ev;
+}
+
+/** * env - clone an environment, 0 if it can't be **/
+/* only between top level evals, the clone shares the heap copy on write */
+auto env_clone(void* env) -> uintptr_t {
+  return (uintptr_t)Env::Clone(reinterpret_cast<Env*>(env));
 }
 
 } /* namespace api */
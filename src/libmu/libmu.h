@@ -42,6 +42,7 @@ void withCondition(void*, const std::function<void(void*)>&);
 uintptr_t env_default(Platform*);
 uintptr_t env(Platform*, Platform::StreamId, Platform::StreamId,
               Platform::StreamId);
+uintptr_t env_clone(void*);
 }
 
 } /* namespace api */
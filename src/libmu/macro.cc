@@ -56,12 +56,13 @@ auto MacroExpand1(Env* env, Tag form) -> std::pair<bool, Tag> {
 
 } /* anonymous namespace */
 
-/** * garbage collection **/
-auto Macro::GcMark(Env* env, Tag macro) -> void {
+/** * relocate macro **/
+auto Macro::GcRelocate(Env* env, Tag macro) -> void {
   assert(IsType(macro));
 
-  TagFormat<Layout>::GcMark(macro);
-  env->GcMark(env, func(macro));
+  auto mp = Untag<Layout>(macro);
+
+  mp->func = Env::Forward(env, mp->func);
 }
 
 /** * make view of macro **/
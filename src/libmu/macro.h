@@ -54,7 +54,11 @@ class Macro : public Type {
   static auto MacroExpand(Env*, Tag) -> Tag;
   static auto MacroFunction(Env*, Tag) -> Tag;
 
-  static auto GcMark(Env*, Tag) -> void;
+  static constexpr auto GcLayout() -> GcSlots {
+    return {1, {offsetof(Layout, func) / 8}};
+  }
+
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto Print(Env*, Tag, Tag, bool) -> void;
   static auto ViewOf(Env*, Tag) -> Tag;
 
@@ -121,8 +121,10 @@ auto Block(Frame* fp) -> void {
                      "is not a function (::block)", fn);
 
   try {
-    fp->value =
-        core::Eval(fp->env, Cons::List(fp->env, std::vector<Type::Tag>{fn}));
+    auto form = Cons::List(fp->env, std::vector<Type::Tag>{fn});
+    core::Env::Root root(fp->env, form);
+
+    fp->value = core::Eval(fp->env, form);
   } catch (
       Type::Tag ex) { /* think: don't we need a specific return condition? */
     if (Cons::IsType(ex) && Type::Eq(tag, Cons::car(ex))) {
@@ -144,7 +146,7 @@ auto Return(Frame* fp) -> void {
     Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
                      "is not a symbol (%return)", tag);
 
-  throw Cons(tag, value).Evict(fp->env);
+  throw Cons::Make(fp->env, tag, value);
 }
 
 } /* namespace mu */
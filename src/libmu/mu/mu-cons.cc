@@ -117,7 +117,7 @@ auto ListLength(Frame* fp) -> void {
 
 /** * (cons object object) => cons **/
 auto MakeCons(Frame* fp) -> void {
-  fp->value = Cons(fp->argv[0], fp->argv[1]).Evict(fp->env);
+  fp->value = Cons::Make(fp->env, fp->argv[0], fp->argv[1]);
 }
 
 /** * (car list) => object **/
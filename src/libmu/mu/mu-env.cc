@@ -40,7 +40,10 @@ using Type = core::Type;
 
 /** * (eval object) => object **/
 auto Eval(Frame* fp) -> void {
-  fp->value = core::Eval(fp->env, core::Compile(fp->env, fp->argv[0]));
+  auto compiled = core::Compile(fp->env, fp->argv[0]);
+  core::Env::Root root(fp->env, compiled);
+
+  fp->value = core::Eval(fp->env, compiled);
 }
 
 /** * (env-view) => vector **/
@@ -80,10 +83,7 @@ auto Apply(Frame* fp) -> void {
     Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
                      "is not a list (.apply)", args);
 
-  std::vector<Type::Tag> argv;
-  core::Cons::ListToVec(args, argv);
-
-  fp->value = core::Function::Funcall(fp->env, func, argv);
+  fp->value = core::Apply(fp->env, func, args);
 }
 
 } /* namespace mu */
@@ -117,7 +117,7 @@ auto Truncate(Frame* fp) -> void {
   auto quot = ifx0 < ifx1 ? 0 : ifx0 / ifx1;
   auto rem = quot == 0 ? ifx0 : ifx0 - (ifx1 * quot);
 
-  fp->value = core::Cons(Fixnum(quot).tag_, Fixnum(rem).tag_).Evict(fp->env);
+  fp->value = core::Cons::Make(fp->env, Fixnum(quot).tag_, Fixnum(rem).tag_);
 }
 
 /** * (floor fixnum fixnum) => (fixnum . fixnum) **/
@@ -144,7 +144,7 @@ auto Floor(Frame* fp) -> void {
   auto rem = nx - (nx / dx) * dx;
   auto quot = (nx - rem) / dx;
 
-  fp->value = core::Cons(Fixnum(quot).tag_, Fixnum(rem).tag_).Evict(fp->env);
+  fp->value = core::Cons::Make(fp->env, Fixnum(quot).tag_, Fixnum(rem).tag_);
 }
 
 /** * (logand fixnum fixnum) => fixnum **/
@@ -25,6 +25,7 @@
 
 #include "libmu/heap/heap.h"
 #include "libmu/types/condition.h"
+#include "libmu/types/string.h"
 
 namespace libmu {
 namespace mu {
@@ -35,25 +36,149 @@ using Frame = core::Env::Frame;
 using Type = core::Type;
 
 /** * (gc bool) => fixnum **/
+/* :t collects the whole heap, :nil only the nursery. :compact collects the
+ * whole heap and compacts it when control returns to top level. with a
+ * slice budget configured, :t starts an incremental mark cycle and returns
+ * 0; any collection requested while a cycle is running finishes it. */
 auto Gc(Frame* fp) -> void {
   auto arg = fp->argv[0];
 
+  if (Type::Eq(arg, core::Symbol::Keyword("compact"))) {
+    fp->env->compact_ = true;
+    arg = Type::T;
+  }
+
+  /* called from the compiler or the reader, collect at the next gc point */
+  if (fp->env->nogc_ && (Type::Eq(arg, Type::T) || Type::Null(arg))) {
+    fp->env->gc_pending_ = true;
+    fp->value = core::Fixnum(0).tag_;
+    return;
+  }
+
   switch (arg) {
     case Type::NIL:
+      fp->value = core::Fixnum(fp->env->GcMinor(fp->env)).tag_;
+      break;
     case Type::T:
+      if (fp->env->slice_usecs_ && !fp->env->marking_ &&
+          !fp->env->compact_) {
+        fp->env->GcStart(fp->env);
+        fp->value = core::Fixnum(0).tag_;
+      } else
+        fp->value = core::Fixnum(fp->env->Gc(fp->env)).tag_;
       break;
     default:
       Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
                        "is not boolean (gc)", arg);
   }
+}
+
+/** * (save-image path) => string **/
+/* the heap is compacted and written when control returns to top level */
+auto SaveImage(Frame* fp) -> void {
+  auto path = fp->argv[0];
+
+  if (!core::String::IsType(path))
+    Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                     "is not a string (save-image)", path);
 
-  fp->value = core::Fixnum(fp->env->Gc(fp->env)).tag_;
+  fp->env->image_ = core::String::StdStringOf(path);
+  fp->value = path;
+}
+
+/** * (gc-config key value) => value **/
+/* :slice is the incremental marking budget in microseconds, 0 collects
+ * stop the world. :threads is the number of threads marking a stop the
+ * world collection. :bitmap :t keeps mark bits in a side bitmap instead of
+ * the object headers. :release is how free pages go back to the system,
+ * :eager at once, :lazy when the system wants them, :nil never. */
+auto GcConfig(Frame* fp) -> void {
+  static const int64_t MAX_MARK_THREADS = 64;
+
+  auto key = fp->argv[0];
+  auto value = fp->argv[1];
+
+  if (Type::Eq(key, core::Symbol::Keyword("slice"))) {
+    if (!Fixnum::IsType(value) || Fixnum::Int64Of(value) < 0)
+      Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                       "is not a slice budget (gc-config)", value);
+
+    fp->env->slice_usecs_ = Fixnum::Uint64Of(value);
+  } else if (Type::Eq(key, core::Symbol::Keyword("threads"))) {
+    if (!Fixnum::IsType(value) || Fixnum::Int64Of(value) < 1 ||
+        Fixnum::Int64Of(value) > MAX_MARK_THREADS)
+      Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                       "is not a mark thread count (gc-config)", value);
+
+    fp->env->mark_threads_ = Fixnum::Uint64Of(value);
+  } else if (Type::Eq(key, core::Symbol::Keyword("bitmap"))) {
+    if (!Type::Eq(value, Type::T) && !Type::Null(value))
+      Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                       "is not boolean (gc-config)", value);
+
+    if (fp->env->marking_) (void)core::Env::GcFinish(fp->env);
+    fp->env->heap_->UseBitmap(Type::Eq(value, Type::T));
+  } else if (Type::Eq(key, core::Symbol::Keyword("release"))) {
+    using RELEASE = heap::Heap::RELEASE;
+
+    if (Type::Eq(value, core::Symbol::Keyword("eager")))
+      fp->env->heap_->release_ = RELEASE::DONTNEED;
+    else if (Type::Eq(value, core::Symbol::Keyword("lazy")))
+      fp->env->heap_->release_ = RELEASE::FREE;
+    else if (Type::Null(value))
+      fp->env->heap_->release_ = RELEASE::NONE;
+    else
+      Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                       "is not a release policy (gc-config)", value);
+  } else
+    Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                     "is not a gc configuration key (gc-config)", key);
+
+  fp->value = value;
 }
 
 /** * (heap-info type) => vector **/
+/* nhits and nmisses count allocations served/not served by the free lists */
 auto HeapInfo(Frame* fp) -> void {
   auto type = fp->argv[0];
 
+  /** * :gc => #(nminor minor-usecs minor-last nmajor major-usecs major-last
+   *              max-pause p99-pause max-finish) **/
+  if (Type::Eq(type, core::Symbol::Keyword("gc"))) {
+    auto& minor = fp->env->heap_->minor_;
+    auto& major = fp->env->heap_->major_;
+
+    fp->value = core::Vector(fp->env,
+                             std::vector<Type::Tag>{
+                                 Fixnum(minor.ncollections).tag_,
+                                 Fixnum(minor.usecs).tag_,
+                                 Fixnum(minor.last_usecs).tag_,
+                                 Fixnum(major.ncollections).tag_,
+                                 Fixnum(major.usecs).tag_,
+                                 Fixnum(major.last_usecs).tag_,
+                                 Fixnum(fp->env->heap_->max_pause_).tag_,
+                                 Fixnum(fp->env->heap_->PauseP99()).tag_,
+                                 Fixnum(fp->env->heap_->max_finish_).tag_})
+                    .tag_;
+    return;
+  }
+
+  /** * :pages => #(committed max resident released nreleases large) **/
+  if (Type::Eq(type, core::Symbol::Keyword("pages"))) {
+    auto heap = fp->env->heap_.get();
+
+    fp->value = core::Vector(fp->env,
+                             std::vector<Type::Tag>{
+                                 Fixnum(heap->size()).tag_,
+                                 Fixnum(heap->max_size()).tag_,
+                                 Fixnum(heap->resident()).tag_,
+                                 Fixnum(heap->released()).tag_,
+                                 Fixnum(heap->nreleases_).tag_,
+                                 Fixnum(heap->nlarge_bytes_).tag_})
+                    .tag_;
+    return;
+  }
+
   if (!core::Symbol::IsKeyword(type) || !Type::IsClassSymbol(type))
     Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
                      "is not a system class keyword (heap-info)", type);
@@ -70,6 +195,12 @@ auto HeapInfo(Frame* fp) -> void {
                            .tag_,
                        Fixnum(fp->env->heap_->nfree_->at(
                                   static_cast<int>(sys_class)))
+                           .tag_,
+                       Fixnum(fp->env->heap_->nhits_->at(
+                                  static_cast<int>(sys_class)))
+                           .tag_,
+                       Fixnum(fp->env->heap_->nmisses_->at(
+                                  static_cast<int>(sys_class)))
                            .tag_})
 
             .tag_;
@@ -96,6 +227,12 @@ auto HeapInfo(Frame* fp) -> void {
                       .tag_,
                   Fixnum(std::accumulate(fp->env->heap_->nfree_->begin(),
                                          fp->env->heap_->nfree_->end(), 0))
+                      .tag_,
+                  Fixnum(std::accumulate(fp->env->heap_->nhits_->begin(),
+                                         fp->env->heap_->nhits_->end(), 0))
+                      .tag_,
+                  Fixnum(std::accumulate(fp->env->heap_->nmisses_->begin(),
+                                         fp->env->heap_->nmisses_->end(), 0))
                       .tag_})
               .tag_;
       break;
@@ -94,7 +94,7 @@ auto MakeNamespace(Frame* fp) -> void {
                        it->car);
   }
 
-  fp->value = Namespace(name, imports).Evict(fp->env);
+  fp->value = Namespace::Make(fp->env, name, imports);
   Env::AddNamespace(fp->env, fp->value);
 }
 
@@ -108,15 +108,14 @@ auto NamespaceSymbols(Frame* fp) -> void {
 
   std::vector<Type::Tag> interns;
 
-  for (auto map : Namespace::interns(ns)) interns.push_back(map.second);
+  for (auto sym : Namespace::interns(ns)) interns.push_back(sym);
 
   std::vector<Type::Tag> externs;
 
-  for (auto map : Namespace::externs(ns)) externs.push_back(map.second);
+  for (auto sym : Namespace::externs(ns)) externs.push_back(sym);
 
-  fp->value = core::Cons(core::Cons::List(fp->env, externs),
-                         core::Cons::List(fp->env, interns))
-                  .Evict(fp->env);
+  fp->value = core::Cons::Make(fp->env, core::Cons::List(fp->env, externs),
+                               core::Cons::List(fp->env, interns));
 }
 
 /** * (ns->current) => ns **/
@@ -198,7 +197,7 @@ auto InternNamespace(Frame* fp) -> void {
     Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR, "intern",
                      name);
 
-  if (!Symbol::IsBound(fp->value)) Symbol::Bind(fp->value, value);
+  if (!Symbol::IsBound(fp->value)) Symbol::Bind(fp->env, fp->value, value);
 }
 
 } /* namespace mu */
@@ -313,6 +313,15 @@ auto Close(Frame* fp) -> void {
 auto Load(Frame* fp) -> void {
   auto filespec = fp->argv[0];
 
+  /* the form and its compilation are only held on the C++ stack */
+  auto load_form = [fp](Type::Tag form) {
+    core::Env::Root src(fp->env, form);
+    auto compiled = core::Compile(fp->env, form);
+    core::Env::Root root(fp->env, compiled);
+
+    (void)core::Eval(fp->env, compiled);
+  };
+
   if (!String::IsType(filespec))
     Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
                      "argument must be a filespec (load)", filespec);
@@ -320,8 +329,7 @@ auto Load(Frame* fp) -> void {
   switch (Type::TypeOf(filespec)) {
     case Type::SYS_CLASS::STREAM:
       while (!Platform::IsEof(Stream::streamId(filespec)))
-        core::Eval(fp->env,
-                   core::Compile(fp->env, core::Read(fp->env, filespec)));
+        load_form(core::Read(fp->env, filespec));
 
       break;
     case Type::SYS_CLASS::STRING: {
@@ -332,9 +340,10 @@ auto Load(Frame* fp) -> void {
         Condition::Raise(fp->env, Condition::CONDITION_CLASS::FILE_ERROR,
                          "(load)", filespec);
 
+      core::Env::Root root(fp->env, istream);
+
       while (!Platform::IsEof(Stream::streamId(istream)))
-        core::Eval(fp->env,
-                   core::Compile(fp->env, core::Read(fp->env, istream)));
+        load_form(core::Read(fp->env, istream));
 
       if (Type::Null(Stream::Close(istream)))
         Condition::Raise(fp->env, Condition::CONDITION_CLASS::STREAM_ERROR,
@@ -90,7 +90,7 @@ auto UninternedSymbol(Frame* fp) -> void {
     Condition::Raise(fp->env, Condition::CONDITION_CLASS::TYPE_ERROR,
                      "uninterned-symbol", fp->argv[0]);
 
-  fp->value = Symbol(Type::NIL, fp->argv[0]).Evict(fp->env);
+  fp->value = Symbol::Make(fp->env, Type::NIL, fp->argv[0]);
 }
 
 /** * (keyword string) */
@@ -52,9 +52,9 @@ void FloatLessThan(Frame*);
 void FloatMul(Frame*);
 void FloatSub(Frame*);
 void Floor(Frame*);
-void FrameRef(Frame*);
 void FunctionStream(Frame*);
 void Gc(Frame*);
+void GcConfig(Frame*);
 void GetNamespace(Frame*);
 void GetStringStream(Frame*);
 void HeapInfo(Frame*);
@@ -81,7 +81,6 @@ void IsStruct(Frame*);
 void IsSymbol(Frame*);
 void IsThread(Frame*);
 void IsVector(Frame*);
-void Letq(Frame*);
 void ListLength(Frame*);
 void Load(Frame*);
 void Log(Frame*);
@@ -114,6 +113,7 @@ void Read(Frame*);
 void ReadByte(Frame*);
 void ReadChar(Frame*);
 void Return(Frame*);
+void SaveImage(Frame*);
 void SetMacroChar(Frame*);
 void SetNamespace(Frame*);
 void Sine(Frame*);
@@ -16,6 +16,7 @@
 #include <cstring>
 #include <ctime>
 
+#include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -57,6 +58,90 @@ auto Platform::MapPages(unsigned npages, const char *heapId) -> const char * {
   return base;
 }
 
+/** * map file pages copy on write over reserved pages **/
+auto Platform::MapFile(const char *path, size_t offset, char *base,
+                       size_t npages) -> bool {
+  auto fd = open(path, O_RDONLY);
+
+  if (fd < 0) return false;
+
+  auto addr = mmap(base, npages * PAGESIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_FIXED, fd, offset);
+
+  close(fd);
+
+  return addr == base;
+}
+
+/** * anonymous file, named by path while open **/
+auto Platform::OpenTemp(const char *name, std::string *path) -> int {
+  auto fd = memfd_create(name, 0);
+
+  if (fd >= 0) *path = "/proc/self/fd/" + std::to_string(fd);
+
+  return fd;
+}
+
+/** * close anonymous file, gone once unmapped **/
+auto Platform::CloseTemp(int fd) -> void { close(fd); }
+
+/** * reserve address space, no memory behind it yet **/
+auto Platform::ReservePages(size_t npages) -> char * {
+  auto base = (char *)mmap(nullptr, npages * PAGESIZE, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+  return base == (char *)-1 ? nullptr : base;
+}
+
+/** * commit reserved pages, optionally backed by huge pages **/
+auto Platform::CommitPages(char *base, size_t npages, bool hugepages) -> bool {
+  if (mprotect(base, npages * PAGESIZE, PROT_READ | PROT_WRITE) != 0)
+    return false;
+
+#if defined(MADV_HUGEPAGE)
+  if (hugepages) (void)madvise(base, npages * PAGESIZE, MADV_HUGEPAGE);
+#else
+  (void)hugepages;
+#endif
+
+  return true;
+}
+
+/** * give committed pages back to the system, they read as zero after **/
+/* lazy is MADV_FREE, the system takes the pages only under pressure */
+auto Platform::ReleasePages(char *base, size_t npages, bool lazy) -> bool {
+#if defined(MADV_FREE)
+  if (lazy) return madvise(base, npages * PAGESIZE, MADV_FREE) == 0;
+#else
+  (void)lazy;
+#endif
+
+  return madvise(base, npages * PAGESIZE, MADV_DONTNEED) == 0;
+}
+
+/** * count resident pages **/
+auto Platform::ResidentPages(char *base, size_t npages) -> size_t {
+  std::vector<unsigned char> incore(npages);
+
+  if (mincore(base, npages * PAGESIZE, incore.data()) != 0) return 0;
+
+  return std::count_if(incore.begin(), incore.end(),
+                       [](unsigned char page) { return page & 1; });
+}
+
+/** * map fresh zeroed pages anywhere **/
+auto Platform::AllocPages(size_t npages) -> char * {
+  auto base = (char *)mmap(nullptr, npages * PAGESIZE, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  return base == (char *)-1 ? nullptr : base;
+}
+
+/** * unmap pages from AllocPages **/
+auto Platform::FreePages(char *base, size_t npages) -> void {
+  (void)munmap(base, npages * PAGESIZE);
+}
+
 /** * get system clock time in millseconds**/
 auto Platform::SystemTime(uint64_t *retn) -> void {
   struct timeval now;
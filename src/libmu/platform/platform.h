@@ -73,6 +73,15 @@ class Platform {
  public: /* persistance */
   static const int PAGESIZE = 4096;
   static const char *MapPages(unsigned, const char *);
+  static char *ReservePages(size_t);
+  static bool CommitPages(char *, size_t, bool);
+  static bool ReleasePages(char *, size_t, bool);
+  static size_t ResidentPages(char *, size_t);
+  static char *AllocPages(size_t);
+  static void FreePages(char *, size_t);
+  static bool MapFile(const char *, size_t, char *, size_t);
+  static int OpenTemp(const char *, std::string *);
+  static void CloseTemp(int);
 
  public: /* streams */
   typedef int64_t StreamId;
@@ -13,9 +13,7 @@
  **/
 #include <bitset>
 #include <cassert>
-#include <functional>
 #include <iomanip>
-#include <map>
 #include <sstream>
 #include <utility>
 
@@ -69,24 +67,12 @@ void PrintAsBroket(Env* env, Tag object, Tag str) {
 void Print(Env* env, Tag object, Tag str, bool esc) {
   auto stream = Stream::StreamDesignator(env, str);
 
-  static const std::map<SYS_CLASS, std::function<void(Env*, Tag, Tag, bool)>>
-      kPrinMap{{SYS_CLASS::CHAR, Char::Print},
-               {SYS_CLASS::CONS, Cons::Print},
-               {SYS_CLASS::FIXNUM, Fixnum::Print},
-               {SYS_CLASS::FLOAT, Float::Print},
-               {SYS_CLASS::FUNCTION, Function::Print},
-               {SYS_CLASS::MACRO, Macro::Print},
-               {SYS_CLASS::NAMESPACE, Namespace::Print},
-               {SYS_CLASS::STRING, String::Print},
-               {SYS_CLASS::SYMBOL, Symbol::Print},
-               {SYS_CLASS::VECTOR, Vector::Print}};
-
-  auto printh = kPrinMap.count(Type::TypeOf(object)) != 0;
-
-  if (printh)
-    kPrinMap.at(Type::TypeOf(object))(env, object, stream, esc);
-  else
+  auto print = Type::TraitsOf(Type::TypeOf(object)).print;
+
+  if (print == nullptr)
     PrintAsBroket(env, object, stream);
+  else
+    print(env, object, stream, esc);
 }
 
 /** * print newline to stream **/
@@ -122,18 +122,18 @@ auto RadixFixnum(Env* env, int radix, Tag stream) -> Tag {
     if (n == str.length()) {
       if (((fxval >> 62) & 1) ^ ((fxval >> 63) & 1))
         Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                         "parse-number", String(env, str).tag_);
+                         "parse-number", String::Make(env, str));
       number = Fixnum(fxval).tag_;
     }
   } catch (std::invalid_argument& ex) {
     Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                     "parse-number", String(env, str).tag_);
+                     "parse-number", String::Make(env, str));
   } catch (std::out_of_range& ex) {
     Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                     "parse-number", String(env, str).tag_);
+                     "parse-number", String::Make(env, str));
   } catch (std::exception& ex) {
     Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                     "parse-number", String(env, str).tag_);
+                     "parse-number", String::Make(env, str));
   }
 
   return number;
@@ -150,7 +150,7 @@ auto Number(Env* env, const std::string& str) -> Tag {
     if (n == str.length()) {
       if (((fxval >> 62) & 1) ^ ((fxval >> 63) & 1))
         Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                         "parse-number:fixnum", String(env, str).tag_);
+                         "parse-number:fixnum", String::Make(env, str));
 
       number = Fixnum(fxval).tag_;
     } else {
@@ -164,7 +164,7 @@ auto Number(Env* env, const std::string& str) -> Tag {
     return Type::NIL;
   } catch (std::exception& ex) {
     Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                     "malformed float", String(env, str).tag_);
+                     "malformed float", String::Make(env, str));
   }
 
   return number;
@@ -203,11 +203,15 @@ auto ReadForm(Env* env, Tag stream_designator) -> Tag {
 
   auto ch = Stream::ReadByte(env, stream);
 
-  /* macro character expander */
+  /* macro character expander. the forms read so far aren't roots, so it
+   * runs with collection held off */
   auto chm = Char(Fixnum::Int64Of(ch)).tag_;
-  if (env->readtable_.count(chm) > 0)
+  if (env->readtable_.count(chm) > 0) {
+    Env::NoGc nogc(env);
+
     return Function::Funcall(env, env->readtable_[chm],
                              std::vector<Tag>{stream, chm});
+  }
 
   switch (MapSyntaxChar(ch)) {
     case SYNTAX_CHAR::COMMENT:
@@ -257,9 +261,7 @@ auto ReadForm(Env* env, Tag stream_designator) -> Tag {
                                "read", stream);
             rval = Cons::List(
                 env, std::vector<Tag>{
-                         Namespace::FindSymbol(env, env->mu_,
-                                               String(env, "closure").tag_),
-                         fn});
+                         Namespace::FindSymbol(env, env->mu_, "closure"), fn});
             break;
           }
           case SYNTAX_CHAR::COLON: { /* uninterned symbol */
@@ -267,13 +269,16 @@ auto ReadForm(Env* env, Tag stream_designator) -> Tag {
             rval = Number(env, atom);
             if (!Type::Null(rval))
               Condition::Raise(env, Condition::CONDITION_CLASS::READER_ERROR,
-                               "uninterned symbol", String(env, atom).tag_);
+                               "uninterned symbol", String::Make(env, atom));
             rval = Symbol::ParseSymbol(env, atom, false);
             break;
           }
-          case SYNTAX_CHAR::DOT: /* read-time eval */
+          case SYNTAX_CHAR::DOT: { /* read-time eval */
+            Env::NoGc nogc(env);
+
             rval = Eval(env, Compile(env, ReadForm(env, stream)));
             break;
+          }
           case SYNTAX_CHAR::VBAR: /* block comment */
             for (;;) {
               ch = Stream::ReadByte(env, stream);
@@ -62,20 +62,6 @@ class TagFormat {
     return heap::Heap::SysClass(static_cast<HeapInfo>(hinfo));
   }
 
-  /** * heap object marked? **/
-  static auto IsGcMarked(Tag ptr) -> bool {
-    auto hinfo = GetHeapInfo(ptr);
-
-    return heap::Heap::RefBits(*hinfo) == 0 ? false : true;
-  }
-
-  /** * mark heap object **/
-  static auto GcMark(Tag ptr) -> void {
-    auto hinfo = GetHeapInfo(ptr);
-
-    *hinfo = heap::Heap::RefBits(*hinfo, 1);
-  }
-
   /** * dump tag format **/
   template <typename T>
   void DumpTag(Tag ptr) {
@@ -22,11 +22,15 @@
 #include "libmu/core.h"
 #include "libmu/macro.h"
 
+#include "libmu/heap/heap.h"
+
+#include "libmu/types/char.h"
 #include "libmu/types/condition.h"
 #include "libmu/types/cons.h"
 #include "libmu/types/fixnum.h"
 #include "libmu/types/float.h"
 #include "libmu/types/function.h"
+#include "libmu/types/namespace.h"
 #include "libmu/types/stream.h"
 #include "libmu/types/string.h"
 #include "libmu/types/struct.h"
@@ -105,39 +109,154 @@ auto Type::MapClassSymbol(SYS_CLASS sys_class) -> Tag {
 }
 
 /** * type of tagged pointer **/
+/* the low tag settles everything but immediates and extended objects,
+ * extended objects keep their class in the heap header */
 auto Type::TypeOf(Tag ptr) -> SYS_CLASS {
-  static const std::vector<std::pair<bool (*)(Tag), SYS_CLASS>> kPredMap{
-      {Char::IsType, SYS_CLASS::CHAR},
-      {Cons::IsType, SYS_CLASS::CONS},
-      {Condition::IsType, SYS_CLASS::CONDITION},
-      {Double::IsType, SYS_CLASS::DOUBLE},
-      {Fixnum::IsType, SYS_CLASS::FIXNUM},
-      {Float::IsType, SYS_CLASS::FLOAT},
-      {Function::IsType, SYS_CLASS::FUNCTION},
-      {Macro::IsType, SYS_CLASS::MACRO},
-      {Namespace::IsType, SYS_CLASS::NAMESPACE},
-      {Stream::IsType, SYS_CLASS::STREAM},
-      {String::IsType, SYS_CLASS::STRING},
-      {Struct::IsType, SYS_CLASS::STRUCT},
-      {Symbol::IsType, SYS_CLASS::SYMBOL},
-      {Vector::IsType, SYS_CLASS::VECTOR}};
-
-  auto el =
-      std::find_if(kPredMap.begin(), kPredMap.end(),
-                   [ptr](const std::pair<bool (*)(Tag), SYS_CLASS> predicate) {
-                     return predicate.first(ptr);
-                   });
-
-  if (el == kPredMap.end()) {
-    printf("TypeOf: 0x%llx: heapInfo 0x016%llx", ptr, *(Untag<Tag>(ptr) - 1));
-    heap::Heap::Dump(
-        *(reinterpret_cast<heap::Heap::HeapInfo*>(Untag<Tag>(ptr) - 1)));
+  switch (TagOf(ptr)) {
+    case TAG::EFIXNUM:
+    case TAG::OFIXNUM:
+      return SYS_CLASS::FIXNUM;
+    case TAG::DOUBLE:
+      return SYS_CLASS::DOUBLE;
+    case TAG::SYMBOL:
+      return SYS_CLASS::SYMBOL;
+    case TAG::FUNCTION:
+      return SYS_CLASS::FUNCTION;
+    case TAG::CONS:
+      return SYS_CLASS::CONS;
+    case TAG::IMMEDIATE:
+      switch (ImmediateClass(ptr)) {
+        case IMMEDIATE_CLASS::CHAR:
+          return SYS_CLASS::CHAR;
+        case IMMEDIATE_CLASS::STRING:
+          return SYS_CLASS::STRING;
+        case IMMEDIATE_CLASS::KEYWORD:
+          return SYS_CLASS::SYMBOL;
+        case IMMEDIATE_CLASS::FLOAT:
+          return SYS_CLASS::FLOAT;
+      }
+      break;
+    case TAG::EXTEND:
+      return heap::Heap::SysClass(*(Untag<heap::Heap::HeapInfo>(ptr) - 1));
   }
 
-  assert(el != kPredMap.end());
+  assert(!"type botch");
+  return SYS_CLASS::T;
+}
+
+namespace {
+
+constexpr Type::GcSlots kNoSlots{0, {0, 0, 0, 0}};
+
+/** * immediates are their own eviction **/
+auto NoEvict(Env*, Tag ptr) -> Tag { return ptr; }
+
+/** * class trait members **/
+/* each is looked up by the signature its trait calls for, so an overload
+ * can't hide it. a class that doesn't declare one gets the default. */
+template <typename C>
+constexpr auto SlotsOf(int) -> decltype(C::GcLayout()) {
+  return C::GcLayout();
+}
+
+template <typename C>
+constexpr auto SlotsOf(...) -> Type::GcSlots {
+  return kNoSlots;
+}
+
+template <typename C>
+constexpr auto ScanOf(int)
+    -> decltype(static_cast<void (*)(Env*, Tag)>(C::GcScan)) {
+  return C::GcScan;
+}
+
+template <typename C>
+constexpr auto ScanOf(...) -> void (*)(Env*, Tag) {
+  return nullptr;
+}
+
+template <typename C>
+constexpr auto RelocateOf(int)
+    -> decltype(static_cast<void (*)(Env*, Tag)>(C::GcRelocate)) {
+  return C::GcRelocate;
+}
+
+template <typename C>
+constexpr auto RelocateOf(...) -> void (*)(Env*, Tag) {
+  return nullptr;
+}
 
-  return el->second;
+template <typename C>
+constexpr auto EvictOf(int)
+    -> decltype(static_cast<Tag (*)(Env*, Tag)>(C::EvictTag)) {
+  return C::EvictTag;
 }
 
+template <typename C>
+constexpr auto EvictOf(...) -> Tag (*)(Env*, Tag) {
+  return NoEvict;
+}
+
+template <typename C>
+constexpr auto ViewOf(int)
+    -> decltype(static_cast<Tag (*)(Env*, Tag)>(C::ViewOf)) {
+  return C::ViewOf;
+}
+
+template <typename C>
+constexpr auto ViewOf(...) -> Tag (*)(Env*, Tag) {
+  return nullptr;
+}
+
+template <typename C>
+constexpr auto PrintOf(int)
+    -> decltype(static_cast<void (*)(Env*, Tag, Tag, bool)>(C::Print)) {
+  return C::Print;
+}
+
+template <typename C>
+constexpr auto PrintOf(...) -> void (*)(Env*, Tag, Tag, bool) {
+  return nullptr;
+}
+
+/** * dispatch entry of a type class **/
+template <typename C>
+constexpr auto ClassTraits() -> Type::Traits {
+  return {SlotsOf<C>(0),  ScanOf<C>(0), RelocateOf<C>(0),
+          EvictOf<C>(0),  ViewOf<C>(0), PrintOf<C>(0)};
+}
+
+/** * classes without objects of their own **/
+constexpr Type::Traits kNoTraits{kNoSlots, nullptr, nullptr,
+                                 nullptr,  nullptr, nullptr};
+
+} /* anonymous namespace */
+
+/** * class dispatch table, indexed by SYS_CLASS **/
+/* tag slots at fixed offsets come from the type layouts, anything else
+ * (vector elements, namespace tables, function contexts) from a scan
+ * function. strings scan, relocate and evict as the vectors they are. */
+constexpr Type::Traits kTypeTraits[]{
+    kNoTraits,                /* BYTE */
+    ClassTraits<Char>(),      /* CHAR */
+    ClassTraits<Condition>(), /* CONDITION */
+    ClassTraits<Cons>(),      /* CONS */
+    ClassTraits<Double>(),    /* DOUBLE */
+    ClassTraits<Fixnum>(),    /* FIXNUM */
+    ClassTraits<Float>(),     /* FLOAT */
+    ClassTraits<Function>(),  /* FUNCTION */
+    ClassTraits<Macro>(),     /* MACRO */
+    ClassTraits<Namespace>(), /* NAMESPACE */
+    ClassTraits<Stream>(),    /* STREAM */
+    ClassTraits<String>(),    /* STRING */
+    ClassTraits<Struct>(),    /* STRUCT */
+    ClassTraits<Symbol>(),    /* SYMBOL */
+    kNoTraits,                /* T */
+    ClassTraits<Vector>()};   /* VECTOR */
+
+static_assert(sizeof(kTypeTraits) / sizeof(kTypeTraits[0]) ==
+                  static_cast<size_t>(Type::SYS_CLASS::VECTOR) + 1,
+              "class dispatch table botch");
+
 } /* namespace core */
 } /* namespace libmu */
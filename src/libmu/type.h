@@ -15,6 +15,7 @@
 #define LIBMU_TYPE_H_
 
 #include <cassert>
+#include <cstddef>
 #include <cinttypes>
 #include <functional>
 #include <map>
@@ -165,6 +166,26 @@ class Type {
   static constexpr bool Null(Tag ptr) { return Eq(ptr, NIL); }
   static std::string SysClassOf(SYS_CLASS);
 
+  /** * tag slots of a heap layout, word offsets for the collector **/
+  typedef struct {
+    size_t nslots;
+    size_t slots[4];
+  } GcSlots;
+
+  /** * per-class dispatch, indexed by SYS_CLASS **/
+  /* a null entry means the class has nothing to do there: nothing more
+   * to scan or relocate, no eviction, no view, printed in broket syntax */
+  typedef struct {
+    GcSlots slots;                       /* collector tag slots */
+    void (*scan)(Env*, Tag);             /* collector, everything else */
+    void (*relocate)(Env*, Tag);         /* compactor */
+    Tag (*evict)(Env*, Tag);             /* copy to the heap */
+    Tag (*view)(Env*, Tag);              /* view vector */
+    void (*print)(Env*, Tag, Tag, bool); /* printer */
+  } Traits;
+
+  static auto TraitsOf(SYS_CLASS) -> const Traits&;
+
  public:    /* object model */
   Tag tag_; /* tagged pointer for type constructors */
 
@@ -172,6 +193,13 @@ class Type {
 
 }; /* class Type */
 
+/** * class dispatch table, in type.cc **/
+extern const Type::Traits kTypeTraits[];
+
+inline auto Type::TraitsOf(SYS_CLASS sys_class) -> const Traits& {
+  return kTypeTraits[static_cast<size_t>(sys_class)];
+}
+
 } /* namespace core */
 } /* namespace libmu */
 
@@ -62,17 +62,16 @@ auto Condition::EvictTag(Env* env, Tag cond) -> Tag {
   return Entag(hp, TAG::EXTEND);
 }
 
-/** * garbage collection **/
-auto Condition::GcMark(Env* env, Tag condition) -> void {
+/** * relocate condition **/
+auto Condition::GcRelocate(Env* env, Tag condition) -> void {
   assert(IsType(condition));
 
-  if (!TagFormat<Layout>::IsGcMarked(condition)) {
-    TagFormat<Layout>::GcMark(condition);
-    env->GcMark(env, tag(condition));
-    env->GcMark(env, source(condition));
-    env->GcMark(env, frame(condition));
-    env->GcMark(env, reason(condition));
-  }
+  auto cp = Untag<Layout>(condition);
+
+  cp->tag = Env::Forward(env, cp->tag);
+  cp->frame = Env::Forward(env, cp->frame);
+  cp->source = Env::Forward(env, cp->source);
+  cp->reason = Env::Forward(env, cp->reason);
 }
 
 /** * make view of condition **/
@@ -99,7 +99,13 @@ class Condition : public Type {
 
  public: /* object */
   static auto EvictTag(Env*, Tag) -> Tag;
-  static auto GcMark(Env*, Tag) -> void;
+  static constexpr auto GcLayout() -> GcSlots {
+    return {4,
+            {offsetof(Layout, tag) / 8, offsetof(Layout, frame) / 8,
+             offsetof(Layout, source) / 8, offsetof(Layout, reason) / 8}};
+  }
+
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto ViewOf(Env* env, Tag) -> Tag;
 
   [[noreturn]] static auto Raise(Env*, CONDITION_CLASS, const std::string&, Tag)
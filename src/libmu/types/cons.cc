@@ -27,15 +27,14 @@
 namespace libmu {
 namespace core {
 
-/** * garbage collection **/
-auto Cons::GcMark(Env* env, Tag ptr) -> void {
+/** * relocate cons **/
+auto Cons::GcRelocate(Env* env, Tag ptr) -> void {
   assert(IsType(ptr));
 
-  if (!TagFormat<Layout>::IsGcMarked(ptr)) {
-    TagFormat<Layout>::GcMark(ptr);
-    env->GcMark(env, car(ptr));
-    env->GcMark(env, cdr(ptr));
-  }
+  auto cp = Untag<Layout>(ptr);
+
+  cp->car = Env::Forward(env, cp->car);
+  cp->cdr = Env::Forward(env, cp->cdr);
 }
 
 /** * view of cons object **/
@@ -65,13 +64,14 @@ auto Cons::MapCar(Env* env, Tag func, Tag list) -> Tag {
 
   if (Null(list)) return NIL;
 
-  std::vector<Tag> vlist;
+  /* the results are roots until they're listed */
+  Env::RootMark results(env);
 
   cons_iter<Tag> iter(list);
   for (auto it = iter.begin(); it != iter.end(); it = ++iter)
-    vlist.push_back(Function::Funcall(env, func, std::vector<Tag>{it->car}));
+    results.push(Function::Funcall(env, func, std::vector<Tag>{it->car}));
 
-  return Cons::List(env, vlist);
+  return Cons::List(env, results.roots());
 }
 
 /** * mapc function list **/
@@ -93,13 +93,14 @@ auto Cons::MapList(Env* env, Tag func, Tag list) -> Tag {
 
   if (Null(list)) return NIL;
 
-  std::vector<Tag> vlist;
+  Env::RootMark results(env);
+
   cons_iter<Tag> iter(list);
   for (auto it = iter.begin(); it != iter.end(); it = ++iter)
-    vlist.push_back(Function::Funcall(
+    results.push(Function::Funcall(
         env, func, std::vector<Tag>{Type::Entag(it, TAG::CONS)}));
 
-  return Cons::List(env, vlist);
+  return Cons::List(env, results.roots());
 }
 
 /** * maplist :func list **/
@@ -115,6 +116,16 @@ auto Cons::MapL(Env* env, Tag func, Tag list) -> void {
                             std::vector<Tag>{Type::Entag(it, TAG::CONS)});
 }
 
+/** * allocate a cons in the heap **/
+auto Cons::Make(Env* env, Tag car, Tag cdr) -> Tag {
+  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::CONS);
+
+  hp->car = Env::Evict(env, car);
+  hp->cdr = Env::Evict(env, cdr);
+
+  return Entag(hp, TAG::CONS);
+}
+
 /** * make a list from a std::vector **/
 auto Cons::List(Env* env, const std::vector<Tag>& src) -> Tag {
   if (src.size() == 0) return NIL;
@@ -122,7 +133,7 @@ auto Cons::List(Env* env, const std::vector<Tag>& src) -> Tag {
   Tag rlist = NIL;
 
   for (auto nth = src.size(); nth; --nth)
-    rlist = Cons(src[nth - 1], rlist).Evict(env);
+    rlist = Make(env, src[nth - 1], rlist);
 
   return rlist;
 }
@@ -131,11 +142,11 @@ auto Cons::List(Env* env, const std::vector<Tag>& src) -> Tag {
 auto Cons::ListDot(Env* env, const std::vector<Tag>& src) -> Tag {
   if (src.size() == 0) return NIL;
 
-  Tag rlist = Cons(src[src.size() - 2], src[src.size() - 1]).Evict(env);
+  Tag rlist = Make(env, src[src.size() - 2], src[src.size() - 1]);
 
   if (src.size() > 2)
     for (auto nth = src.size() - 2; nth != 0; --nth)
-      rlist = Cons(src[nth - 1], rlist).Evict(env);
+      rlist = Make(env, src[nth - 1], rlist);
 
   return rlist;
 }
@@ -260,14 +271,7 @@ auto Cons::Read(Env* env, Tag stream) -> Tag {
 
 /** * evict cons to heap **/
 auto Cons::Evict(Env* env) -> Tag {
-  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::CONS);
-
-  *hp = cons_;
-
-  hp->car = Env::Evict(env, cons_.car);
-  hp->cdr = Env::Evict(env, cons_.cdr);
-
-  tag_ = Entag(hp, TAG::CONS);
+  tag_ = Make(env, cons_.car, cons_.cdr);
 
   return tag_;
 }
@@ -276,17 +280,7 @@ auto Cons::EvictTag(Env* env, Tag cons) -> Tag {
   assert(IsType(cons));
   assert(!Env::IsEvicted(env, cons));
 
-  // printf("EvictTag: cons\n");
-
-  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::CONS);
-  auto cp = Untag<Layout>(cons);
-
-  *hp = *cp;
-
-  hp->car = Env::Evict(env, cp->car);
-  hp->cdr = Env::Evict(env, cp->cdr);
-
-  return Entag(hp, TAG::CONS);
+  return Make(env, Cons::car(cons), Cons::cdr(cons));
 }
 
 /** * allocate cons **/
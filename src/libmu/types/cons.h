@@ -58,6 +58,7 @@ class Cons : public Type {
   }
 
   static auto ListToVec(Tag, std::vector<Tag>&) -> void;
+  static auto Make(Env*, Tag, Tag) -> Tag;
   static auto List(Env*, const std::vector<Tag>&) -> Tag;
   static auto ListDot(Env*, const std::vector<Tag>&) -> Tag;
 
@@ -73,7 +74,11 @@ class Cons : public Type {
   static auto Print(Env*, Tag, Tag, bool) -> void;
   static auto Read(Env*, Tag) -> Tag;
 
-  static auto GcMark(Env*, Tag) -> void;
+  static constexpr auto GcLayout() -> GcSlots {
+    return {2, {offsetof(Layout, car) / 8, offsetof(Layout, cdr) / 8}};
+  }
+
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto ViewOf(Env* env, Tag) -> Tag;
 
  public: /* type model */
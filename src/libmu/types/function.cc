@@ -14,6 +14,7 @@
 #include "libmu/types/function.h"
 
 #include <cassert>
+#include <cstring>
 #include <sstream>
 
 #include "libmu/core.h"
@@ -21,6 +22,7 @@
 #include "libmu/type.h"
 
 #include "libmu/compiler.h"
+#include "libmu/vm.h"
 
 #include "libmu/types/condition.h"
 #include "libmu/types/cons.h"
@@ -35,12 +37,14 @@ namespace {
 /** * call function on frame **/
 auto CallFrame(Env::Frame* fp) -> void {
   fp->value = Type::NIL;
-  if (Type::Null(Function::mu(fp->func))) {
+  if (!Type::Null(Function::code(fp->func)))
+    Exec(fp);
+  else if (Type::Null(Function::mu(fp->func))) {
     Cons::cons_iter<Tag> iter(Cons::cdr(Function::form(fp->func)));
     for (auto it = iter.begin(); it != iter.end(); it = ++iter)
       fp->value = core::Eval(fp->env, it->car);
   } else
-    Type::Untag<Env::TagFn>(Function::mu(fp->func))->fn(fp);
+    fp->env->CoreFunction(Function::mu(fp->func))->fn(fp);
 }
 
 /** * arity checking **/
@@ -60,12 +64,11 @@ auto arity_rest(Tag fn) -> bool {
 }
 
 /** * run-time function call argument arity validation **/
-auto CheckArity(Env* env, Tag fn, const std::vector<Tag>& args) -> void {
+auto CheckArity(Env* env, Tag fn, size_t nargs) -> void {
   assert(Function::IsType(fn));
 
   size_t nreqs = arity_nreqs(fn);
   auto rest = arity_rest(fn);
-  auto nargs = args.size();
 
   if (nargs < nreqs)
     Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR,
@@ -83,19 +86,36 @@ auto CheckArity(Env* env, Tag fn, const std::vector<Tag>& args) -> void {
 
 } /* anonymous namespace */
 
-/** * garbage collection **/
-auto Function::GcMark(Env* ev, Tag fn) -> void {
+/** * queue function references for marking **/
+auto Function::GcScan(Env* ev, Tag fn) -> void {
   assert(IsType(fn));
 
-  if (!TagFormat<Layout>::IsGcMarked(fn)) {
-    TagFormat<Layout>::GcMark(fn);
-    ev->GcMark(ev, env(fn));
-    ev->GcMark(ev, form(fn));
-    ev->GcMark(ev, name(fn));
-    for (auto fp : context(fn)) {
-      Env::GcFrame(fp);
-    }
-  }
+  ev->GcMark(ev, env(fn));
+  ev->GcMark(ev, form(fn));
+  ev->GcMark(ev, code(fn));
+  ev->GcMark(ev, name(fn));
+  for (auto fp : context(fn)) Env::GcFrame(fp);
+}
+
+/** * relocate function **/
+auto Function::GcRelocate(Env* ev, Tag fn) -> void {
+  assert(IsType(fn));
+
+  auto fp = Untag<Layout>(fn);
+
+  fp->name = Env::Forward(ev, fp->name);
+  fp->form = Env::Forward(ev, fp->form);
+  fp->code = Env::Forward(ev, fp->code);
+  fp->env = Env::Forward(ev, fp->env);
+  for (auto frame : fp->context) Env::ForwardFrame(frame);
+}
+
+/** * empty context for a function mapped from an image **/
+/* the context vector isn't in the heap, the image has only stale pointers */
+auto Function::ImageReset(Tag fn) -> void {
+  assert(IsType(fn));
+
+  new (&Untag<Layout>(fn)->context) std::vector<Frame*>();
 }
 
 /** * function printer **/
@@ -134,51 +154,115 @@ auto Function::ViewOf(Env* env, Tag fn) -> Tag {
                                frame_id(fn),
                                Fixnum(arity(fn)).tag_};
 
-  return Vector(env, view).tag_;
+  return Vector::Make(env, view);
 }
 
-/** * call function with argument vector **/
-auto Function::Funcall(Env* env, Tag fn, const std::vector<Tag>& argv) -> Tag {
+/** * close function over its static chain **/
+auto Function::Closure(Env* env, Tag fn) -> Tag {
   assert(IsType(fn));
 
-  size_t nargs = arity_nreqs(fn) + ((arity_rest(fn) ? 1 : 0));
-
-  CheckArity(env, fn, argv);
+  if (!Null(Function::env(fn))) {
+    std::vector<Frame*> context{};
 
-  auto args = std::make_unique<Tag[]>(nargs);
-  if (nargs) {
-    size_t i = 0;
-    for (; i < arity_nreqs(fn); i++) args[i] = argv[i];
+    /* copy the static chain, outermost frame first */
+    auto lfp = Env::FindFrame(env, parent(fn));
+    if (lfp == nullptr)
+      Condition::Raise(env, Condition::CONDITION_CLASS::CONTROL_ERROR,
+                       "closure: no enclosing frame", fn);
 
-    if (arity_rest(fn)) {
-      if (i == argv.size()) {
-        args[i] = NIL;
-      } else {
-        std::vector<Tag> restv;
+    for (; lfp != nullptr; lfp = lfp->link) {
+      auto args = new Tag[lfp->nargs];
 
-        for (size_t j = i; j < argv.size(); j++) restv.push_back(argv[j]);
+      for (size_t i = 0; i < lfp->nargs; ++i) args[i] = lfp->argv[i];
 
-        args[i] = Cons::List(env, restv);
-      }
+      auto nf = new Frame(env, lfp->frame_id, lfp->func, args, lfp->nargs);
+      context.insert(context.begin(), nf);
     }
+
+    Function::context(env, fn, context);
   }
 
-  Env::Frame fp(env, frame_id(fn), fn, args.get(), nargs);
+  return fn;
+}
+
+/** * reuse frame for a call in tail position **/
+/* the arguments are moved down over the frame's and the frame becomes the
+ * callee's. a lambda that isn't a closure may find its lexical parent
+ * through the frame being replaced, it gets a frame of its own. */
+auto Function::TailCall(Frame* fp, Tag fn, Tag* argv, size_t nargs) -> bool {
+  auto env = fp->env;
 
-  env->PushFrame(&fp);
+  if (!IsType(fn) || Null(code(fn))) return false;
+  if (!ncontext(fn) && !Null(Function::env(fn))) return false;
 
-  if (nargs) env->Cache(&fp);
+  CheckArity(env, fn, nargs);
 
-  for (auto frame : Function::context(fn))
-    if (frame->nargs) env->Cache(frame);
+  std::memmove(fp->argv, argv, nargs * sizeof(Tag));
+  env->argp_ = (fp->argv - env->args_.get()) + nargs;
 
-  CallFrame(&fp);
+  fp->frame_id = frame_id(fn);
+  fp->func = fn;
+  fp->nargs = nargs;
+  fp->link = context_frame(fn);
+
+  if (arity_rest(fn)) {
+    size_t nreqs = arity_nreqs(fn);
+
+    env->PushArg(NIL);
 
-  for (auto frame : Function::context(fn))
-    if (frame->nargs) env->UnCache(frame);
+    auto rest = &env->args_[env->argp_ - 1];
+    for (auto j = nargs; j > nreqs; --j)
+      *rest = Cons::Make(env, fp->argv[j - 1], *rest);
 
-  if (nargs) env->UnCache(&fp);
+    fp->argv[nreqs] = *rest;
+    fp->nargs = nreqs + 1;
+  }
+
+  return true;
+}
+
+/** * call function with argument vector **/
+auto Function::Funcall(Env* env, Tag fn, const std::vector<Tag>& argv) -> Tag {
+  Env::ArgMark mark(env);
+
+  for (auto arg : argv) env->PushArg(arg);
+
+  return Funcall(env, fn, mark.argv(), mark.nargs());
+}
+
+/** * call function on the top nargs of the argument stack **/
+/* the frame is built over the arguments in place. a :rest list is consed
+ * into the slot after the required arguments, pushing one if need be */
+auto Function::Funcall(Env* env, Tag fn, Tag* argv, size_t nargs) -> Tag {
+  assert(IsType(fn));
+  assert(argv + nargs == &env->args_[env->argp_]);
 
+  CheckArity(env, fn, nargs);
+
+  if (arity_rest(fn)) {
+    size_t nreqs = arity_nreqs(fn);
+
+    env->PushArg(NIL);
+
+    auto rest = &env->args_[env->argp_ - 1];
+    for (auto j = nargs; j > nreqs; --j)
+      *rest = Cons::Make(env, argv[j - 1], *rest);
+
+    argv[nreqs] = *rest;
+    nargs = nreqs + 1;
+  }
+
+  Env::Frame fp(env, frame_id(fn), fn, argv, nargs);
+
+  /* closures link to their context, other lambdas to an active frame */
+  if (ncontext(fn))
+    fp.link = context_frame(fn);
+  else if (!Null(Function::env(fn)))
+    fp.link = Env::FindFrame(env, parent(fn));
+
+  env->PushFrame(&fp);
+  Env::GcPoint(env);
+  CallFrame(&fp);
   env->PopFrame();
 
   return fp.value;
@@ -41,6 +41,7 @@ class Function : public Type {
     Tag name;     /* debugging */
     Tag mu;       /* as an address */
     Tag form;     /* as a lambda */
+    Tag code;     /* as bytecode */
     Tag env;      /* closures */
     Tag frame_id; /* lexical reference */
     size_t arity; /* arity checking */
@@ -71,9 +72,30 @@ class Function : public Type {
     return Untag<Layout>(fn)->context.size();
   }
 
-  static auto context(Tag fn, std::vector<Frame*> ctx) -> std::vector<Frame*> {
+  /** * innermost closed over frame **/
+  static auto context_frame(Tag fn) -> Frame* {
     assert(IsType(fn));
 
+    auto& context = Untag<Layout>(fn)->context;
+    return context.empty() ? nullptr : context.back();
+  }
+
+  static auto context(Env* ev, Tag fn, std::vector<Frame*> ctx)
+      -> std::vector<Frame*> {
+    assert(IsType(fn));
+
+    for (auto fp : Untag<Layout>(fn)->context)
+      for (size_t i = 0; i < fp->nargs; ++i)
+        Env::WriteBarrier(ev, fn, fp->argv[i], NIL);
+
+    for (auto fp : ctx)
+      for (size_t i = 0; i < fp->nargs; ++i)
+        Env::WriteBarrier(ev, fn, NIL, fp->argv[i]);
+
+    /* the context is a static chain, outermost frame first */
+    for (size_t i = 0; i < ctx.size(); ++i)
+      ctx[i]->link = i ? ctx[i - 1] : nullptr;
+
     Untag<Layout>(fn)->context = ctx;
     return ctx;
   }
@@ -84,22 +106,50 @@ class Function : public Type {
     return Untag<Layout>(fn)->env;
   }
 
-  static auto env(Tag fn, Tag env) -> Tag {
+  /** * lexically enclosing function **/
+  static auto parent(Tag fn) -> Tag {
     assert(IsType(fn));
 
+    auto parent = NIL;
+    Cons::cons_iter<Tag> iter(env(fn));
+    for (auto it = iter.begin(); it != iter.end(); it = ++iter)
+      parent = it->car;
+
+    return parent;
+  }
+
+  static auto env(Env* ev, Tag fn, Tag env) -> Tag {
+    assert(IsType(fn));
+
+    Env::WriteBarrier(ev, fn, Untag<Layout>(fn)->env, env);
     Untag<Layout>(fn)->env = env;
     return env;
   }
 
+  static auto code(Tag fn) -> Tag {
+    assert(IsType(fn));
+
+    return Untag<Layout>(fn)->code;
+  }
+
+  static auto code(Env* env, Tag fn, Tag code) -> Tag {
+    assert(IsType(fn));
+
+    Env::WriteBarrier(env, fn, Untag<Layout>(fn)->code, code);
+    Untag<Layout>(fn)->code = code;
+    return code;
+  }
+
   static auto form(Tag fn) -> Tag {
     assert(IsType(fn));
 
     return Untag<Layout>(fn)->form;
   }
 
-  static auto form(Tag fn, Tag form) -> Tag {
+  static auto form(Env* env, Tag fn, Tag form) -> Tag {
     assert(IsType(fn));
 
+    Env::WriteBarrier(env, fn, Untag<Layout>(fn)->form, form);
     Untag<Layout>(fn)->form = form;
     return form;
   }
@@ -110,6 +160,14 @@ class Function : public Type {
     return Untag<Layout>(fn)->mu;
   }
 
+  static auto mu(Tag fn, Tag mu) -> Tag {
+    assert(IsType(fn));
+    assert(Fixnum::IsType(mu));
+
+    Untag<Layout>(fn)->mu = mu;
+    return mu;
+  }
+
   static auto frame_id(Tag fn) -> Tag {
     assert(IsType(fn));
 
@@ -122,17 +180,23 @@ class Function : public Type {
     return Untag<Layout>(fn)->name;
   }
 
-  static auto name(Tag fn, Tag symbol) -> Tag {
+  static auto name(Env* env, Tag fn, Tag symbol) -> Tag {
     assert(IsType(fn));
     assert(Symbol::IsType(symbol));
 
+    Env::WriteBarrier(env, fn, Untag<Layout>(fn)->name, symbol);
     Untag<Layout>(fn)->name = symbol;
     return symbol;
   }
 
+  static auto Closure(Env*, Tag) -> Tag;
   static auto Funcall(Env*, Tag, const std::vector<Tag>&) -> Tag;
+  static auto Funcall(Env*, Tag, Tag*, size_t) -> Tag;
+  static auto TailCall(Frame*, Tag, Tag*, size_t) -> bool;
 
-  static auto GcMark(Env*, Tag) -> void;
+  static auto GcScan(Env*, Tag) -> void;
+  static auto GcRelocate(Env*, Tag) -> void;
+  static auto ImageReset(Tag) -> void;
   static auto Print(Env*, Tag, Tag, bool) -> void;
   static auto ViewOf(Env* env, Tag) -> Tag;
 
@@ -144,6 +208,7 @@ class Function : public Type {
     *hp = function_;
     hp->name = Env::Evict(env, function_.name);
     hp->form = Env::Evict(env, function_.form);
+    hp->code = Env::Evict(env, function_.code);
     hp->env = Env::Evict(env, function_.env);
 
     tag_ = Entag(hp, TAG::FUNCTION);
@@ -163,6 +228,7 @@ class Function : public Type {
 
     hp->name = Env::Evict(env, fp->name);
     hp->form = Env::Evict(env, fp->form);
+    hp->code = Env::Evict(env, fp->code);
     hp->env = Env::Evict(env, fp->env);
 
     return Entag(hp, TAG::FUNCTION);
@@ -177,6 +243,7 @@ class Function : public Type {
         Fixnum(reinterpret_cast<uintptr_t>(const_cast<Env::TagFn*>(mu))).tag_;
     function_.env = NIL;
     function_.form = NIL;
+    function_.code = NIL;
     function_.frame_id = Fixnum(env->frame_id_).tag_;
     function_.name = name;
 
@@ -190,6 +257,16 @@ class Function : public Type {
       : Type() {
     assert(Cons::IsList(form));
 
+    /* blocks are in the lexical environment, but have no frames */
+    auto lambdas = [](Env* env) {
+      std::vector<Tag> fns;
+
+      for (auto fn : env->lexenv_)
+        if (IsType(fn)) fns.push_back(fn);
+
+      return fns;
+    };
+
     auto arity_of = [env, lambda]() -> size_t {
       auto nsyms = Cons::Length(env, Cons::car(lambda));
       auto rest = !Type::Null(Cons::cdr(lambda));
@@ -200,8 +277,9 @@ class Function : public Type {
     function_.arity = arity_of();
     function_.context = context;
     function_.mu = NIL;
-    function_.env = Cons::List(env, env->lexenv_);
+    function_.env = Cons::List(env, lambdas(env));
     function_.form = form;
+    function_.code = NIL;
     function_.frame_id = Fixnum(env->frame_id_).tag_;
     function_.name = name;
 
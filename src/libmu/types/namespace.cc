@@ -14,6 +14,7 @@
 #include "libmu/types/namespace.h"
 
 #include <cassert>
+#include <cstring>
 #include <vector>
 
 #include "libmu/core.h"
@@ -31,58 +32,216 @@
 namespace libmu {
 namespace core {
 
-/** * garbage collect the namespace **/
-auto Namespace::GcMark(Env* env, Tag ns) -> void {
+/** * queue namespace references for marking **/
+/* the table vectors are scanned in place like any other vector */
+auto Namespace::GcScan(Env* env, Tag ns) -> void {
   assert(IsType(ns));
 
-  if (!TagFormat<Layout>::IsGcMarked(ns)) {
-    TagFormat<Layout>::GcMark(ns);
-    env->GcMark(env, name(ns));
-    env->GcMark(env, imports(ns));
-    for (auto entry : externs(ns)) Symbol::GcMark(env, entry.second);
-    for (auto entry : interns(ns)) Symbol::GcMark(env, entry.second);
+  auto np = Untag<Layout>(ns);
+
+  env->GcMark(env, np->name);
+  env->GcMark(env, np->imports);
+  env->GcMark(env, np->externs.hashes);
+  env->GcMark(env, np->externs.symbols);
+  env->GcMark(env, np->interns.hashes);
+  env->GcMark(env, np->interns.symbols);
+  env->GcMark(env, np->cache.hashes);
+  env->GcMark(env, np->cache.symbols);
+}
+
+/** * relocate namespace **/
+auto Namespace::GcRelocate(Env* env, Tag ns) -> void {
+  assert(IsType(ns));
+
+  auto np = Untag<Layout>(ns);
+
+  np->name = Env::Forward(env, np->name);
+  np->imports = Env::Forward(env, np->imports);
+  np->externs.hashes = Env::Forward(env, np->externs.hashes);
+  np->externs.symbols = Env::Forward(env, np->externs.symbols);
+  np->interns.hashes = Env::Forward(env, np->interns.hashes);
+  np->interns.symbols = Env::Forward(env, np->interns.symbols);
+  np->cache.hashes = Env::Forward(env, np->cache.hashes);
+  np->cache.symbols = Env::Forward(env, np->cache.symbols);
+}
+
+/** * empty symbol table of nslots, a power of two **/
+auto Namespace::MakeTable(Env* env, size_t nslots) -> Table {
+  assert((nslots & (nslots - 1)) == 0);
+
+  /* a copy, the vector constructor would odr-use NIL */
+  Tag empty = NIL;
+
+  return {Vector::Make(env, std::vector<int64_t>(nslots, 0)),
+          Vector::Make(env, std::vector<Tag>(nslots, empty)), 0};
+}
+
+/** * find symbol by name in a table **/
+auto Namespace::Lookup(const Table& table, const char* name, size_t len,
+                       uint64_t hash) -> Tag {
+  auto hashes = table.hashes;
+  auto symbols = table.symbols;
+  auto mask = Vector::Length(symbols) - 1;
+
+  auto hashv = Vector::Data<uint64_t>(hashes);
+  auto symv = Vector::Data<Tag>(symbols);
+
+  for (auto nth = hash & mask; !Null(symv[nth]); nth = (nth + 1) & mask) {
+    if (hashv[nth] != hash) continue;
+
+    auto str = Symbol::name(symv[nth]);
+
+    if (String::Length(str) == len &&
+        std::memcmp(String::Data<char>(str), name, len) == 0)
+      return symv[nth];
   }
+
+  return NIL;
+}
+
+/** * empty a table in place **/
+auto Namespace::ClearTable(Env* env, Table* table) -> void {
+  auto symbols = table->symbols;
+  auto symv = Vector::Data<Tag>(symbols);
+
+  for (size_t nth = 0; nth < Vector::Length(symbols); ++nth)
+    if (!Null(symv[nth])) {
+      Env::WriteBarrier(env, symbols, symv[nth], NIL);
+      symv[nth] = NIL;
+    }
+
+  table->count = 0;
+}
+
+/** * symbols in a table, in slot order **/
+auto Namespace::TableSymbols(const Table& table) -> std::vector<Tag> {
+  std::vector<Tag> symv;
+  auto symbols = table.symbols;
+
+  Vector::vector_iter<Tag> iter(symbols);
+  for (auto it = iter.begin(); it != iter.end(); it = ++iter)
+    if (!Null(*it)) symv.push_back(*it);
+
+  return symv;
 }
 
 /** * view of namespace object **/
 auto Namespace::ViewOf(Env* env, Tag ns) -> Tag {
   assert(IsType(ns));
 
-  auto view =
-      std::vector<Tag>{Symbol::Keyword("ns"), ns,
-                       Fixnum(ToUint64(ns) >> 3).tag_, name(ns), imports(ns)};
+  auto np = Untag<Layout>(ns);
+  auto view = std::vector<Tag>{Symbol::Keyword("ns"),
+                               ns,
+                               Fixnum(ToUint64(ns) >> 3).tag_,
+                               name(ns),
+                               imports(ns),
+                               Fixnum(np->hits).tag_,
+                               Fixnum(np->misses).tag_};
 
   return Vector(env, view).tag_;
 }
 
+/** * insert symbol in a namespace table **/
+/* the table doubles when it's three quarters full */
+auto Namespace::Insert(Env* env, Tag ns, Table* table, Tag symbol) -> Tag {
+  assert(Symbol::IsType(symbol));
+
+  auto nslots = Vector::Length(table->symbols);
+
+  if ((table->count + 1) * 4 > nslots * 3) {
+    auto grown = MakeTable(env, nslots * 2);
+
+    for (auto sym : TableSymbols(*table)) (void)Insert(env, ns, &grown, sym);
+
+    Env::WriteBarrier(env, ns, table->hashes, grown.hashes);
+    Env::WriteBarrier(env, ns, table->symbols, grown.symbols);
+    *table = grown;
+    nslots *= 2;
+  }
+
+  auto name = Symbol::name(symbol);
+  auto hash = hash_id(String::Data<char>(name), String::Length(name));
+  auto mask = nslots - 1;
+
+  auto hashv = Vector::Data<uint64_t>(table->hashes);
+  auto symv = Vector::Data<Tag>(table->symbols);
+
+  auto nth = hash & mask;
+  while (!Null(symv[nth])) nth = (nth + 1) & mask;
+
+  Env::WriteBarrier(env, table->symbols, NIL, symbol);
+  hashv[nth] = hash;
+  symv[nth] = symbol;
+  table->count++;
+
+  return symbol;
+}
+
+/** * insert symbol in namespace externs **/
+/* a new extern may shadow what any namespace resolved through imports */
+auto Namespace::InsertExtern(Env* env, Tag ns, Tag symbol) -> Tag {
+  env->ns_epoch_++;
+
+  return Insert(env, ns, &Untag<Layout>(ns)->externs, symbol);
+}
+
 /** * find symbol in namespace/imports **/
-auto Namespace::FindSymbol(Env* env, Tag ns, Tag str) -> Tag {
+/* the name is hashed once for the whole import chain, and what the
+ * imports resolve to is cached until the next extern anywhere */
+auto Namespace::FindSymbol(Env* env, Tag ns, const char* name, size_t len,
+                           uint64_t hash) -> Tag {
   assert(IsType(ns));
-  assert(String::IsType(str));
 
-  auto sym = FindExterns(ns, str);
-  if (!Type::Null(sym)) return sym;
+  auto sym = FindExterns(ns, name, len, hash);
+  if (!Type::Null(sym) || Type::Null(imports(ns))) return sym;
+
+  auto np = Untag<Layout>(ns);
+
+  if (np->epoch != env->ns_epoch_) {
+    ClearTable(env, &np->cache);
+    np->epoch = env->ns_epoch_;
+  }
+
+  sym = Lookup(np->cache, name, len, hash);
+  if (!Type::Null(sym)) {
+    np->hits++;
+    return sym;
+  }
+
+  np->misses++;
 
   Cons::cons_iter<Tag> iter(Namespace::imports(ns));
   for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
-    auto sym = FindSymbol(env, it->car, str);
-    if (!Type::Null(sym)) return sym;
+    auto sym = FindSymbol(env, it->car, name, len, hash);
+    if (!Type::Null(sym)) return Insert(env, ns, &np->cache, sym);
   }
 
   return Type::NIL;
 }
 
+auto Namespace::FindSymbol(Env* env, Tag ns, Tag str) -> Tag {
+  assert(String::IsType(str));
+
+  auto name = String::Data<char>(str);
+  auto len = String::Length(str);
+
+  return FindSymbol(env, ns, name, len, hash_id(name, len));
+}
+
+auto Namespace::FindSymbol(Env* env, Tag ns, const std::string& str) -> Tag {
+  return FindSymbol(env, ns, str.data(), str.size(),
+                    hash_id(str.data(), str.size()));
+}
+
 /** * intern extern symbol in namespace **/
 auto Namespace::Intern(Env* env, Tag ns, Tag name) -> Tag {
   assert(IsType(ns));
   assert(String::IsType(name));
 
-  auto key = static_cast<Tag>(hash_id(name));
   auto sym = FindSymbol(env, ns, name);
 
   /* symbols assigned to namespaces are automatically evicted */
-  return Type::Null(sym) ? Insert(Untag<Layout>(ns)->externs, key,
-                                  Symbol(ns, name).Evict(env))
+  return Type::Null(sym) ? InsertExtern(env, ns, Symbol::Make(env, ns, name))
                          : sym;
 }
 
@@ -91,14 +250,12 @@ auto Namespace::Intern(Env* env, Tag ns, Tag name, Tag value) -> Tag {
   assert(IsType(ns));
   assert(String::IsType(name));
 
-  auto key = static_cast<Tag>(hash_id(name));
   auto sym = FindSymbol(env, ns, name);
 
   /* symbols assigned to namespaces are automatically evicted */
-  auto foo = Type::Null(sym) ? Insert(Untag<Layout>(ns)->externs, key,
-                                      Symbol(ns, name, value).Evict(env))
-                             : sym;
-  return foo;
+  return Type::Null(sym)
+             ? InsertExtern(env, ns, Symbol::Make(env, ns, name, value))
+             : sym;
 }
 
 /** * intern symbol in namespace **/
@@ -106,12 +263,11 @@ auto Namespace::InternInNs(Env* env, Tag ns, Tag name) -> Tag {
   assert(IsType(ns));
   assert(String::IsType(name));
 
-  auto key = static_cast<Tag>(hash_id(name));
   auto sym = FindInterns(ns, name);
 
   /* symbols assigned to namespaces are automatically evicted */
-  return Type::Null(sym) ? Insert(Untag<Layout>(ns)->interns, key,
-                                  Symbol(ns, name).Evict(env))
+  return Type::Null(sym) ? Insert(env, ns, &Untag<Layout>(ns)->interns,
+                                  Symbol::Make(env, ns, name))
                          : sym;
 }
 
@@ -120,12 +276,10 @@ auto Namespace::ExternInNs(Env* env, Tag ns, Tag name) -> Tag {
   assert(IsType(ns));
   assert(String::IsType(name));
 
-  auto key = static_cast<Tag>(hash_id(name));
   auto sym = FindExterns(ns, name);
 
   /* symbols assigned to namespaces are automatically evicted */
-  return Type::Null(sym) ? Insert(Untag<Layout>(ns)->externs, key,
-                                  Symbol(ns, name).Evict(env))
+  return Type::Null(sym) ? InsertExtern(env, ns, Symbol::Make(env, ns, name))
                          : sym;
 }
 
@@ -133,42 +287,44 @@ auto Namespace::ExternInNs(Env* env, Tag ns, Tag name) -> Tag {
 auto Namespace::Symbols(Env* env, Tag ns) -> Tag {
   assert(IsType(ns));
 
-  auto syms = Untag<Layout>(ns)->externs;
-  auto list = *syms.get();
+  return Cons::List(env, externs(ns));
+}
+
+/** * allocate a namespace in the heap **/
+auto Namespace::Make(Env* env, Tag name, Tag imports) -> Tag {
+  assert(Cons::IsList(imports));
+  assert(String::IsType(name));
 
-  std::vector<Tag> symv;
+  auto externs = MakeTable(env, TABLE_SIZE);
+  auto interns = MakeTable(env, TABLE_SIZE);
+  auto cache = MakeTable(env, TABLE_SIZE);
+  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::NAMESPACE);
 
-  for (auto map : list) symv.push_back(map.second);
+  hp->name = Env::Evict(env, name);
+  hp->imports = Env::Evict(env, imports);
+  hp->externs = externs;
+  hp->interns = interns;
+  hp->cache = cache;
+  hp->epoch = env->ns_epoch_;
+  hp->hits = 0;
+  hp->misses = 0;
 
-  return Cons::List(env, symv);
+  return Entag(hp, TAG::EXTEND);
 }
 
 /** evict namespace to heap **/
 auto Namespace::Evict(Env* env) -> Tag {
-  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::NAMESPACE);
-
-  *hp = namespace_;
-  hp->name = Env::Evict(env, hp->name);
-  hp->imports = Env::Evict(env, hp->imports);
-
-  tag_ = Entag(hp, TAG::EXTEND);
+  tag_ = Make(env, namespace_.name, namespace_.imports);
 
   return tag_;
 }
 
+/** * namespaces are only staged empty **/
 auto Namespace::EvictTag(Env* env, Tag ns) -> Tag {
   assert(IsType(ns));
   assert(!Env::IsEvicted(env, ns));
 
-  // printf("EvictTag: namespace\n");
-  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::NAMESPACE);
-  auto np = Untag<Layout>(ns);
-
-  *hp = *np;
-  hp->name = Env::Evict(env, hp->name);
-  hp->imports = Env::Evict(env, hp->imports);
-
-  return Entag(hp, TAG::EXTEND);
+  return Make(env, name(ns), imports(ns));
 }
 
 /** * print namespace **/
@@ -197,8 +353,12 @@ Namespace::Namespace(Tag name, Tag imports) : Type() {
 
   namespace_.name = name;
   namespace_.imports = imports;
-  namespace_.externs = std::make_shared<symbol_map>();
-  namespace_.interns = std::make_shared<symbol_map>();
+  namespace_.externs = {NIL, NIL, 0};
+  namespace_.interns = {NIL, NIL, 0};
+  namespace_.cache = {NIL, NIL, 0};
+  namespace_.epoch = 0;
+  namespace_.hits = 0;
+  namespace_.misses = 0;
 
   tagFormat_ =
       new TagFormat<Layout>(SYS_CLASS::NAMESPACE, TAG::EXTEND, &namespace_);
@@ -18,9 +18,7 @@
 #include <cassert>
 #include <functional>
 #include <iostream>
-#include <memory>
 #include <sstream>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -43,50 +41,37 @@ namespace core {
 
 /** * namespace type class **/
 class Namespace : public Type {
- private: /* symbol map, keyed by hash id */
-  /* think: wouldn't it be less stress to key by symbol Tag? */
-  typedef std::unordered_map<uint32_t, Tag> symbol_map;
-  typedef symbol_map::const_iterator symbol_iter;
+ private: /* symbol tables */
+  static const uint64_t FNV_prime = 1099511628211UL;
+  static const uint64_t OFFSET_BASIS = 14695981039346656037UL;
 
-  static const size_t FNV_prime = 16777619;
-  static const uint64_t OFFSET_BASIS = 2166136261UL;
+  static const size_t TABLE_SIZE = 32; /* initial slots, a power of two */
 
-  static auto find(const std::shared_ptr<symbol_map>& map, Tag key)
-      -> symbol_iter {
-    return map->find(static_cast<uint64_t>(key));
-  }
-
-  static auto isFound(const std::shared_ptr<symbol_map>& map, symbol_iter el)
-      -> bool {
-    return el != map->end();
-  }
-
-  static auto Insert(const std::shared_ptr<symbol_map>& map, Tag key,
-                     Tag symbol) -> Tag {
-    (*map.get())[static_cast<uint64_t>(key)] = symbol;
-    return symbol;
-  }
-
-  static auto hash_id(Tag str) -> uint64_t {
-    assert(String::IsType(str));
-
-    uint64_t hash = OFFSET_BASIS;
-
-    Vector::vector_iter<char> iter(str);
-    for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
-      hash ^= *it;
-      hash *= FNV_prime;
-    }
-
-    return hash;
-  }
+  /** * open addressed symbol table, linear probe **/
+  /* the hashes and symbols are heap vectors, :nil is an empty slot */
+  typedef struct {
+    Tag hashes;   /* fixnum vector of full name hashes */
+    Tag symbols;  /* t vector of symbols */
+    size_t count; /* symbols in the table */
+  } Table;
+
+  static auto MakeTable(Env*, size_t) -> Table;
+  static auto Lookup(const Table&, const char*, size_t, uint64_t) -> Tag;
+  static auto Insert(Env*, Tag, Table*, Tag) -> Tag;
+  static auto InsertExtern(Env*, Tag, Tag) -> Tag;
+  static auto ClearTable(Env*, Table*) -> void;
+  static auto TableSymbols(const Table&) -> std::vector<Tag>;
 
  private:
   typedef struct {
     Tag name;    /* string */
     Tag imports; /* list of namespaces */
-    std::shared_ptr<symbol_map> externs;
-    std::shared_ptr<symbol_map> interns;
+    Table externs;
+    Table interns;
+    Table cache;   /* symbols resolved through imports */
+    size_t epoch;  /* env extern epoch the cache is good for */
+    size_t hits;   /* cache statistics */
+    size_t misses;
   } Layout;
 
   Layout namespace_;
@@ -98,6 +83,19 @@ class Namespace : public Type {
            TagFormat<Layout>::SysClass(ptr) == SYS_CLASS::NAMESPACE;
   }
 
+  /** * symbol name hash **/
+  /* computed once by callers that probe more than one table */
+  static auto hash_id(const char* name, size_t len) -> uint64_t {
+    uint64_t hash = OFFSET_BASIS;
+
+    for (size_t i = 0; i < len; ++i) {
+      hash ^= static_cast<uint8_t>(name[i]);
+      hash *= FNV_prime;
+    }
+
+    return hash;
+  }
+
   /** * accessor **/
   static auto name(Tag ns) -> Tag {
     assert(IsType(ns));
@@ -112,16 +110,16 @@ class Namespace : public Type {
     return Untag<Layout>(ns)->imports;
   }
 
-  static auto externs(Tag ns) -> symbol_map {
+  static auto externs(Tag ns) -> std::vector<Tag> {
     assert(IsType(ns));
 
-    return *Untag<Layout>(ns)->externs.get();
+    return TableSymbols(Untag<Layout>(ns)->externs);
   }
 
-  static auto interns(Tag ns) -> symbol_map {
+  static auto interns(Tag ns) -> std::vector<Tag> {
     assert(IsType(ns));
 
-    return *Untag<Layout>(ns)->interns.get();
+    return TableSymbols(Untag<Layout>(ns)->interns);
   }
 
   /** * is in namespace externs? **/
@@ -141,40 +139,60 @@ class Namespace : public Type {
   }
 
   /** * find symbol in namespace externs **/
-  static auto FindExterns(Tag ns, Tag str) -> Tag {
+  static auto FindExterns(Tag ns, const char* name, size_t len, uint64_t hash)
+      -> Tag {
     assert(IsType(ns));
+
+    return Lookup(Untag<Layout>(ns)->externs, name, len, hash);
+  }
+
+  static auto FindExterns(Tag ns, Tag str) -> Tag {
     assert(String::IsType(str));
 
-    auto key = static_cast<Tag>(hash_id(str));
-    auto entry = find(Untag<Layout>(ns)->externs, key);
+    auto name = String::Data<char>(str);
+    auto len = String::Length(str);
 
-    return isFound(Untag<Layout>(ns)->externs, entry) ? entry->second
-                                                      : Type::NIL;
+    return FindExterns(ns, name, len, hash_id(name, len));
   }
 
   /** * find symbol in namespace interns **/
-  static auto FindInterns(Tag ns, Tag str) -> Tag {
+  static auto FindInterns(Tag ns, const char* name, size_t len, uint64_t hash)
+      -> Tag {
     assert(IsType(ns));
+
+    return Lookup(Untag<Layout>(ns)->interns, name, len, hash);
+  }
+
+  static auto FindInterns(Tag ns, Tag str) -> Tag {
     assert(String::IsType(str));
 
-    auto key = static_cast<Tag>(hash_id(str));
-    auto entry = find(Untag<Layout>(ns)->interns, key);
+    auto name = String::Data<char>(str);
+    auto len = String::Length(str);
+
+    return FindInterns(ns, name, len, hash_id(name, len));
+  }
 
-    return isFound(Untag<Layout>(ns)->interns, entry) ? entry->second
-                                                      : Type::NIL;
+  static auto FindInterns(Tag ns, const std::string& str) -> Tag {
+    return FindInterns(ns, str.data(), str.size(),
+                       hash_id(str.data(), str.size()));
   }
 
   static auto Symbols(Env*, Tag) -> Tag;
-  static auto GcMark(Env*, Tag) -> void;
+  static auto GcScan(Env*, Tag) -> void;
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto Intern(Env*, Tag, Tag) -> Tag;
   static auto Intern(Env*, Tag, Tag, Tag) -> Tag;
   static auto InternInNs(Env*, Tag, Tag) -> Tag;
   static auto ExternInNs(Env*, Tag, Tag) -> Tag;
   static auto FindSymbol(Env*, Tag, Tag) -> Tag;
+  static auto FindSymbol(Env*, Tag, const std::string&) -> Tag;
+  static auto FindSymbol(Env*, Tag, const char*, size_t, uint64_t) -> Tag;
   static auto ViewOf(Env* env, Tag) -> Tag;
 
   static auto Print(Env*, Tag, Tag, bool) -> void;
 
+  static auto Make(Env*, Tag, Tag) -> Tag;
+
  public: /* type model */
   auto Evict(Env*) -> Tag;
   static auto EvictTag(Env*, Tag) -> Tag;
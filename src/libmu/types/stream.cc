@@ -42,13 +42,13 @@ auto Stream::IsFunction(Tag ptr) -> bool {
   return IsType(ptr) && Function::IsType(func(ptr));
 }
 
-/** * garbage collection **/
-auto Stream::GcMark(Env*, Tag stream) -> void {
+/** * relocate stream **/
+auto Stream::GcRelocate(Env* env, Tag stream) -> void {
   assert(IsType(stream));
 
-  if (IsFunction(stream)) TagFormat<Layout>::GcMark(func(stream));
+  auto sp = Untag<Layout>(stream);
 
-  TagFormat<Layout>::GcMark(stream);
+  sp->fn = Env::Forward(env, sp->fn);
 }
 
 /** * view of struct object **/
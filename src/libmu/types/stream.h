@@ -100,7 +100,11 @@ class Stream : public Type {
   static auto IsEof(Tag) -> bool;
   static auto Flush(Tag) -> void;
 
-  static auto GcMark(Env*, Tag) -> void;
+  static constexpr auto GcLayout() -> GcSlots {
+    return {1, {offsetof(Layout, fn) / 8}};
+  }
+
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto ViewOf(Env* env, Tag) -> Tag;
 
  public: /* type model */
@@ -71,17 +71,17 @@ class String : public Vector {
     return Type::MakeImmediate(buffer, str.size(), IMMEDIATE_CLASS::STRING);
   }
 
+  /** * strings of up to IMMEDIATE_STR_MAX chars are immediates **/
+  static auto Make(Env* env, const std::string& str) -> Tag {
+    return Vector::Make(env, SYS_CLASS::CHAR, str.data(), str.size());
+  }
+
   static auto Print(Env*, Tag, Tag, bool) -> void;
   static auto Read(Env*, Tag) -> Tag;
   static auto ViewOf(Env* env, Tag) -> Tag;
 
-#if 0
-    if (src.size() <= IMMEDIATE_STR_MAX) {
-    tag_ = String::MakeImmediate(std::string(src.begin(), src.end()));
-#endif
  public: /* object */
-  explicit String(Env* env, std::string src)
-    : VectorT<SYS_CLASS::STRING, char>(env, std::vector<char>(src.begin(), src.end())) {}
+  explicit String(Env* env, const std::string& src) : Vector(Make(env, src)) {}
 };
 
 } /* namespace core */
@@ -45,14 +45,17 @@ class Struct : public Type {
   static auto stype(Tag str) -> Tag { return Untag<Layout>(str)->stype; }
   static auto slots(Tag str) -> Tag { return Untag<Layout>(str)->slots; }
 
-  static auto GcMark(Env* env, Tag ptr) -> void {
+  static constexpr auto GcLayout() -> GcSlots {
+    return {2, {offsetof(Layout, stype) / 8, offsetof(Layout, slots) / 8}};
+  }
+
+  static auto GcRelocate(Env* env, Tag ptr) -> void {
     assert(IsType(ptr));
 
-    if (!TagFormat<Layout>::IsGcMarked(ptr)) {
-      TagFormat<Layout>::GcMark(ptr);
-      env->GcMark(env, slots(ptr));
-      env->GcMark(env, stype(ptr));
-    }
+    auto sp = Untag<Layout>(ptr);
+
+    sp->stype = Env::Forward(env, sp->stype);
+    sp->slots = Env::Forward(env, sp->slots);
   }
 
   /** * view of struct object **/
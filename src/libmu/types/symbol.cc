@@ -32,36 +32,18 @@ namespace libmu {
 namespace core {
 namespace {
 
-/** * parse symbol namespace designator **/
-auto NamespaceOf(Env* env, const std::string& symbol, const std::string& sep)
-    -> Tag {
-  auto cpos = symbol.find(sep);
-  Tag ns;
+/** * map a symbol's namespace designator **/
+auto NamespaceOf(Env* env, const std::string& symbol, size_t cpos) -> Tag {
+  auto ns = Env::MapNamespace(env, symbol.substr(0, cpos));
 
-  if (cpos < symbol.size()) {
-    ns = Env::MapNamespace(env, symbol.substr(0, cpos));
-
-    if (Type::Null(ns))
-      Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                       "unmapped namespace",
-                       String(env, symbol.substr(0, cpos)).tag_);
-  } else {
-    ns = Type::NIL;
-  }
+  if (Type::Null(ns))
+    Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
+                     "unmapped namespace",
+                     String::Make(env, symbol.substr(0, cpos)));
 
   return ns;
 }
 
-/** * parse symbol name string **/
-auto NameOf(Env* env, const std::string& symbol, const std::string& sep)
-    -> Tag {
-  auto cpos = symbol.find(sep);
-
-  return String(env, (cpos < symbol.size()) ? symbol.substr(cpos + sep.length())
-                                            : symbol)
-      .tag_;
-}
-
 } /* anonymous namespace */
 
 /** * view of symbol object **/
@@ -78,15 +60,15 @@ auto Symbol::ViewOf(Env* env, Tag symbol) -> Tag {
   return Vector(env, view).tag_;
 }
 
-/** * garbage collection **/
-auto Symbol::GcMark(Env* env, Tag symbol) -> void {
-  assert(IsType(symbol));
+/** * relocate symbol **/
+auto Symbol::GcRelocate(Env* env, Tag symbol) -> void {
+  assert(IsType(symbol) && !IsKeyword(symbol));
 
-  if (!IsKeyword(symbol) && !TagFormat<Layout>::IsGcMarked(symbol)) {
-    TagFormat<Layout>::GcMark(symbol);
-    env->GcMark(env, name(symbol));
-    env->GcMark(env, value(symbol));
-  }
+  auto sp = Untag<Layout>(symbol);
+
+  sp->ns = Env::Forward(env, sp->ns);
+  sp->name = Env::Forward(env, sp->name);
+  sp->value = Env::Forward(env, sp->value);
 }
 
 /** * set namespace */
@@ -98,6 +80,16 @@ auto Symbol::ns(Tag symbol, Tag ns) -> void {
   Untag<Layout>(symbol)->ns = ns;
 }
 
+/** * bind symbol **/
+auto Symbol::Bind(Env* env, Tag symbol, Tag value) -> Tag {
+  assert(IsType(symbol));
+
+  Env::WriteBarrier(env, symbol, Untag<Layout>(symbol)->value, value);
+  Untag<Layout>(symbol)->value = value;
+
+  return symbol;
+}
+
 /** * is symbol bound to a value? */
 auto Symbol::IsBound(Tag sym) -> bool {
   assert(IsType(sym));
@@ -157,46 +149,76 @@ auto Symbol::ParseSymbol(Env* env, std::string string, bool intern) -> Tag {
     if (string.size() - 1 > Type::IMMEDIATE_STR_MAX)
       Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
                        "keyword symbols may not exceed seven characters",
-                       String(env, string).tag_);
+                       String::Make(env, string));
 
     auto key = string;
     rval = Symbol::Keyword(key.erase(0, 1));
   } else {
-    auto int_ns = NamespaceOf(env, string, "::");
-    auto ext_ns = NamespaceOf(env, string, ":");
-
-    if (intern) {
-      if (!Null(int_ns))
-        rval = Namespace::InternInNs(env, int_ns, NameOf(env, string, "::"));
-      else if (!Null(ext_ns))
-        rval = Namespace::ExternInNs(env, ext_ns, NameOf(env, string, ":"));
-      else {
-        auto name = String(env, string).tag_;
-        rval = Namespace::FindInterns(env->namespace_, name);
-        if (Null(rval)) rval = Namespace::Intern(env, env->namespace_, name);
-      }
-    } else if (Null(ext_ns) && Null(int_ns)) {
-      auto name = String(env, string).tag_;
-      rval = Symbol(NIL, name).Evict(env);
-    } else
-      Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
-                       "uninterned symbols may not be qualified (read)",
-                       String(env, string).tag_);
+    /* look the name up in place, allocate only for a new symbol */
+    auto ipos = string.find("::");
+    auto epos = (ipos == std::string::npos) ? string.find(':') : ipos;
+    auto ns = (epos == std::string::npos) ? env->namespace_
+                                          : NamespaceOf(env, string, epos);
+
+    if (!intern) {
+      if (epos != std::string::npos)
+        Condition::Raise(env, Condition::CONDITION_CLASS::PARSE_ERROR,
+                         "uninterned symbols may not be qualified (read)",
+                         String::Make(env, string));
+
+      return Make(env, NIL, String::Make(env, string));
+    }
+
+    auto off = (epos == std::string::npos) ? 0
+               : (ipos == std::string::npos) ? epos + 1
+                                             : epos + 2;
+    auto name = string.data() + off;
+    auto len = string.size() - off;
+    auto hash = Namespace::hash_id(name, len);
+    auto heap_name = [env, &string, off]() {
+      return String::Make(env, string.substr(off));
+    };
+
+    if (ipos != std::string::npos) {
+      rval = Namespace::FindInterns(ns, name, len, hash);
+      if (Null(rval))
+        rval = Namespace::InternInNs(env, ns, heap_name());
+    } else if (epos != std::string::npos) {
+      rval = Namespace::FindExterns(ns, name, len, hash);
+      if (Null(rval))
+        rval = Namespace::ExternInNs(env, ns, heap_name());
+    } else {
+      rval = Namespace::FindInterns(ns, name, len, hash);
+      if (Null(rval)) rval = Namespace::FindSymbol(env, ns, name, len, hash);
+      if (Null(rval)) rval = Namespace::Intern(env, ns, heap_name());
+    }
   }
 
   return rval;
 }
 
-/** evict symbol to heap **/
-auto Symbol::Evict(Env* env) -> Tag {
+/** * allocate a symbol in the heap **/
+auto Symbol::Make(Env* env, Tag ns, Tag name, Tag value) -> Tag {
+  assert(String::IsType(name));
+  assert(Namespace::IsType(ns) || Null(ns));
+
   auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::SYMBOL);
 
-  *hp = symbol_;
-  hp->ns = Env::Evict(env, hp->ns);
-  hp->name = Env::Evict(env, hp->name);
-  hp->value = Env::Evict(env, hp->value);
+  hp->ns = Env::Evict(env, ns);
+  hp->name = Env::Evict(env, name);
+  hp->value = Env::Evict(env, value);
+
+  return Entag(hp, TAG::SYMBOL);
+}
 
-  tag_ = Entag(hp, TAG::SYMBOL);
+/** * allocate an unbound symbol in the heap **/
+auto Symbol::Make(Env* env, Tag ns, Tag name) -> Tag {
+  return Make(env, ns, name, static_cast<Tag>(core::SYNTAX_CHAR::UNBOUND));
+}
+
+/** evict symbol to heap **/
+auto Symbol::Evict(Env* env) -> Tag {
+  tag_ = Make(env, symbol_.ns, symbol_.name, symbol_.value);
 
   return tag_;
 }
@@ -205,16 +227,9 @@ auto Symbol::EvictTag(Env* env, Tag symbol) -> Tag {
   assert(IsType(symbol));
   assert(!Env::IsEvicted(env, symbol));
 
-  // printf("EvictTag: symbol\n");
-  auto hp = env->heap_alloc<Layout>(sizeof(Layout), SYS_CLASS::SYMBOL);
   auto sp = Untag<Layout>(symbol);
 
-  *hp = *sp;
-  hp->ns = Env::Evict(env, hp->ns);
-  hp->name = Env::Evict(env, hp->name);
-  hp->value = Env::Evict(env, hp->value);
-
-  return Entag(hp, TAG::SYMBOL);
+  return Make(env, sp->ns, sp->name, sp->value);
 }
 
 /** * allocate an unbound symbol from the heap **/
@@ -92,14 +92,16 @@ class Symbol : public Type {
     return Null(Symbol::ns(symbol));
   }
 
-  static auto Bind(Tag symbol, Tag value) -> Tag {
-    assert(IsType(symbol));
-
-    Untag<Layout>(symbol)->value = value;
-    return symbol;
+  static auto Bind(Env*, Tag, Tag) -> Tag;
+  static auto Make(Env*, Tag, Tag) -> Tag;
+  static auto Make(Env*, Tag, Tag, Tag) -> Tag;
+  static constexpr auto GcLayout() -> GcSlots {
+    return {3,
+            {offsetof(Layout, ns) / 8, offsetof(Layout, name) / 8,
+             offsetof(Layout, value) / 8}};
   }
 
-  static auto GcMark(Env*, Tag) -> void;
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto IsBound(Tag) -> bool;
   static auto Print(Env*, Tag, Tag, bool) -> void;
   static auto ParseSymbol(Env*, std::string, bool) -> Tag;
@@ -34,38 +34,49 @@ namespace libmu {
 namespace core {
 /** * evict vector to heap **/
 auto Vector::Evict(Env* env) -> Tag {
-  auto hp = env->heap_alloc<Layout>(
-      sizeof(Layout) + TagFormat<Layout>::HeapWords(vector_.length) * 8,
-      SYS_CLASS::VECTOR);
-
-  *hp = vector_;
-  hp->base = reinterpret_cast<uint64_t>(
-      (char*)hp + TagFormat<Layout>::HeapWords(sizeof(Layout)) * 8);
-
-  std::memcpy(hp + TagFormat<Layout>::HeapWords(sizeof(Layout)) * 8,
-              srcTag_.data(), vector_.length * 8);
-
-  tag_ = Entag(hp, TAG::EXTEND);
+  tag_ = EvictTag(env, tag_);
 
   return tag_;
 }
 
+/** * evict vector tag to heap **/
 auto Vector::EvictTag(Env* env, Tag vector) -> Tag {
-  assert(IsType(vector));
+  assert(IsType(vector) && !IsImmediate(vector));
   assert(!Env::IsEvicted(env, vector));
 
-  Layout* hl = Untag<Layout>(vector);
-  auto hp = env->heap_alloc<Layout>(sizeof(Layout) + length(vector) * 8,
-                                    SYS_CLASS::VECTOR);
+  auto vp = Untag<Layout>(vector);
+
+  return Make(env, vp->type, reinterpret_cast<void*>(vp->base), vp->length);
+}
+
+/** * allocate a vector of type in the heap **/
+/* the data follows the layout, packed to its element width. short char
+ * vectors fit in the tag and never reach the heap */
+auto Vector::Make(Env* env, SYS_CLASS type, const void* src, size_t length)
+    -> Tag {
+  if (type == SYS_CLASS::CHAR && length <= IMMEDIATE_STR_MAX) {
+    uint64_t buffer = 0;
+
+    std::memcpy(&buffer, src, length);
+    return MakeImmediate(buffer, length, IMMEDIATE_CLASS::STRING);
+  }
+
+  auto nbytes = length * ElementSize(type);
+  auto hp = env->heap_alloc<Layout>(
+      sizeof(Layout) + TagFormat<Layout>::HeapWords(nbytes) * 8,
+      HeapClass(type));
+
+  hp->type = type;
+  hp->length = length;
+  hp->base = reinterpret_cast<uint64_t>(hp + 1);
 
-  *hp = *hl;
-  hp->base = reinterpret_cast<uint64_t>(
-      (char*)hp + TagFormat<Layout>::HeapWords(sizeof(Layout)) * 8);
+  std::memcpy(hp + 1, src, nbytes);
 
-  std::memcpy(hp + TagFormat<Layout>::HeapWords(sizeof(Layout)) * 8,
-              reinterpret_cast<char*>(base(vector)), length(vector) * 8);
+  if (type == SYS_CLASS::T) {
+    auto data = reinterpret_cast<Tag*>(hp->base);
 
-  // env->heap_->DumpHeapImage<Layout>(Entag(hp, TAG::EXTEND));
+    for (size_t i = 0; i < length; ++i) data[i] = Env::Evict(env, data[i]);
+  }
 
   return Entag(hp, TAG::EXTEND);
 }
@@ -75,38 +86,64 @@ auto Vector::ViewOf(Env* env, Tag vector) -> Tag {
   assert(IsType(vector));
 
   auto view = std::vector<Tag>{
-      Symbol::Keyword("vector"),          vector,
-      Fixnum(ToUint64(vector) >> 3).tag_, VecType(vector),
-      Fixnum(length(vector)).tag_,        Fixnum(base(vector)).tag_};
+      Symbol::Keyword("vector"),
+      vector,
+      Fixnum(ToUint64(vector) >> 3).tag_,
+      VecType(vector),
+      Fixnum(length(vector)).tag_,
+      Fixnum(base(vector)).tag_,
+      Fixnum(ElementSize(type(vector))).tag_};
 
   return Vector(env, view).tag_;
 }
 
-/** * garbage collection **/
-auto Vector::GcMark(Env* env, Tag vec) -> void {
-  assert(IsType(vec));
-
-  if (!Type::IsImmediate(vec) && !TagFormat<Layout>::IsGcMarked(vec)) {
-    TagFormat<Layout>::GcMark(vec);
-
-    switch (Vector::TypeOf(vec)) {
-      case SYS_CLASS::BYTE:
-      case SYS_CLASS::CHAR:
-      case SYS_CLASS::FIXNUM:
-      case SYS_CLASS::FLOAT:
-        break;
-      case SYS_CLASS::T: {
-        Vector::vector_iter<Tag> iter(vec);
-        for (auto it = iter.begin(); it != iter.end(); it = ++iter)
-          env->GcMark(env, *it);
-        break;
-      }
-      default:
-        assert(!"vector type botch");
+/** * queue vector elements for marking **/
+auto Vector::GcScan(Env* env, Tag vec) -> void {
+  assert(IsType(vec) && !Type::IsImmediate(vec));
+
+  switch (Vector::TypeOf(vec)) {
+    case SYS_CLASS::BYTE:
+    case SYS_CLASS::CHAR:
+    case SYS_CLASS::FIXNUM:
+    case SYS_CLASS::FLOAT:
+      break;
+    case SYS_CLASS::T: {
+      Vector::vector_iter<Tag> iter(vec);
+      for (auto it = iter.begin(); it != iter.end(); it = ++iter)
+        env->GcMark(env, *it);
+      break;
     }
+    default:
+      assert(!"vector type botch");
   }
 }
 
+/** * relocate vector **/
+auto Vector::GcRelocate(Env* env, Tag vec) -> void {
+  assert(IsType(vec) && !Type::IsImmediate(vec));
+
+  auto vp = Untag<Layout>(vec);
+  auto base = vp->base;
+  auto in_heap = env->heap_->in_from(reinterpret_cast<void*>(base));
+
+  /* a rebased heap has already moved, and the data with it */
+  if (in_heap && env->heap_->rebasing())
+    base = vp->base = reinterpret_cast<uint64_t>(
+        env->heap_->Forward(reinterpret_cast<void*>(base)));
+
+  if (vp->type == SYS_CLASS::T) {
+    auto data = reinterpret_cast<Tag*>(base);
+
+    for (size_t i = 0; i < vp->length; ++i)
+      data[i] = Env::Forward(env, data[i]);
+  }
+
+  /* inline data moves with the vector */
+  if (in_heap && !env->heap_->rebasing())
+    vp->base = reinterpret_cast<uint64_t>(env->heap_->Forward(vp)) +
+               (vp->base - reinterpret_cast<uint64_t>(vp));
+}
+
 /** * vector parser **/
 auto Vector::Read(Env* env, Tag stream) -> Tag {
   assert(Stream::IsType(stream));
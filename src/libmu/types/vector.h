@@ -44,12 +44,6 @@ class Vector : public Type {
   Layout vector_;
   TagFormat<Layout>* tagFormat_;
 
-  std::vector<Tag> srcTag_;
-  std::vector<char> srcChar_;
-  std::vector<float> srcFloat_;
-  std::vector<uint8_t> srcByte_;
-  std::vector<int64_t> srcFixnum_;
-
  public: /* Tag */
   /** * accessors **/
   static const size_t MAX_LENGTH = 1024;
@@ -63,6 +57,26 @@ class Vector : public Type {
     return base;
   }
 
+  /** * element width in bytes **/
+  /* byte and char vectors are packed a byte to an element, float vectors
+   * four bytes, fixnum and t vectors a word */
+  static constexpr auto ElementSize(SYS_CLASS type) -> size_t {
+    switch (type) {
+      case SYS_CLASS::BYTE:
+      case SYS_CLASS::CHAR:
+        return 1;
+      case SYS_CLASS::FLOAT:
+        return sizeof(float);
+      default:
+        return 8;
+    }
+  }
+
+  /** * heap class of a vector of type **/
+  static constexpr auto HeapClass(SYS_CLASS type) -> SYS_CLASS {
+    return type == SYS_CLASS::CHAR ? SYS_CLASS::STRING : SYS_CLASS::VECTOR;
+  }
+
   static auto Map(Env*, Tag, Tag) -> Tag;
   static auto MapC(Env*, Tag, Tag) -> void;
 
@@ -77,6 +91,7 @@ class Vector : public Type {
   template <typename T>
   static auto Data(Tag& vector) -> T* {
     assert(IsType(vector));
+    assert(IsImmediate(vector) || sizeof(T) == ElementSize(type(vector)));
 
     return IsImmediate(vector)
                ? reinterpret_cast<T*>(reinterpret_cast<char*>(&vector) + 1)
@@ -114,7 +129,8 @@ class Vector : public Type {
 
   static auto ListToVector(Env*, Tag, Tag) -> Tag;
 
-  static auto GcMark(Env*, Tag) -> void;
+  static auto GcScan(Env*, Tag) -> void;
+  static auto GcRelocate(Env*, Tag) -> void;
   static auto Print(Env*, Tag, Tag, bool) -> void;
   static auto Read(Env*, Tag) -> Tag;
   static auto ViewOf(Env*, Tag) -> Tag;
@@ -128,6 +144,56 @@ class Vector : public Type {
     tag_ = tag;
   }
 
+  explicit Vector(Env* env, const std::vector<Tag>& src) {
+    tagFormat_ = nullptr;
+    tag_ = Make(env, src);
+  }
+
+  explicit Vector(Env* env, const std::vector<char>& src) {
+    tagFormat_ = nullptr;
+    tag_ = Make(env, src);
+  }
+
+  explicit Vector(Env* env, const std::vector<float>& src) {
+    tagFormat_ = nullptr;
+    tag_ = Make(env, src);
+  }
+
+  explicit Vector(Env* env, const std::vector<uint8_t>& src) {
+    tagFormat_ = nullptr;
+    tag_ = Make(env, src);
+  }
+
+  explicit Vector(Env* env, const std::vector<int64_t>& src) {
+    tagFormat_ = nullptr;
+    tag_ = Make(env, src);
+  }
+
+ public: /* allocate in the heap */
+  static auto Make(Env* env, const std::vector<Tag>& src) -> Tag {
+    return Make(env, SYS_CLASS::T, src.data(), src.size());
+  }
+
+  static auto Make(Env* env, const std::vector<char>& src) -> Tag {
+    return Make(env, SYS_CLASS::CHAR, src.data(), src.size());
+  }
+
+  static auto Make(Env* env, const std::vector<float>& src) -> Tag {
+    return Make(env, SYS_CLASS::FLOAT, src.data(), src.size());
+  }
+
+  static auto Make(Env* env, const std::vector<uint8_t>& src) -> Tag {
+    return Make(env, SYS_CLASS::BYTE, src.data(), src.size());
+  }
+
+  static auto Make(Env* env, const std::vector<int64_t>& src) -> Tag {
+    return Make(env, SYS_CLASS::FIXNUM, src.data(), src.size());
+  }
+
+  static auto Make(Env*, SYS_CLASS, const void*, size_t) -> Tag;
+
+ public:
+
   /** * vector iterator **/
   template <typename V>
   struct vector_iter {
@@ -169,25 +235,6 @@ class Vector : public Type {
 
 }; /* class Vector */
 
-/** * VectorT type class **/
-template <SYS_CLASS sc, typename V>
-class VectorT : public Vector {
-private:
-  std::vector<V> src_;
-
- public: /* type model */
-  explicit VectorT(Env*, std::vector<Tag> src) {
-    src_ = src;
-
-    vector_.type = sc;
-    vector_.length = src.size();
-    vector_.base = reinterpret_cast<uint64_t>(src.data());
-
-    tagFormat_ = new TagFormat<Layout>(SYS_CLASS::VECTOR, TAG::EXTEND, &vector_);
-    tag_ = tagFormat_->tag_;
-  }
-}; /* class VectorT */
-
 } /* namespace core */
 } /* namespace libmu */
 
@@ -37,13 +37,19 @@ static auto VMap(Env* env, Tag func, const std::function<T(Tag)>& unbox,
   assert(Function::IsType(func));
   assert(Vector::IsType(vector));
 
+  /* unboxed T elements are tags, root them until the vector is made */
+  Env::RootMark results(env);
   std::vector<T> vec;
+
   Vector::vector_iter<T> iter(vector);
-  for (auto it = iter.begin(); it != iter.end(); it = ++iter)
-    vec.push_back(
-        unbox(Function::Funcall(env, func, std::vector<Tag>{S(*it).tag_})));
+  for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
+    auto value = Function::Funcall(env, func, std::vector<Tag>{S(*it).tag_});
+
+    results.push(value);
+    vec.push_back(unbox(value));
+  }
 
-  return Vector(env, vec).tag_;
+  return Vector::Make(env, vec);
 }
 
 template <typename T, typename S>
@@ -71,7 +77,7 @@ static auto VList(Env* env, const std::function<bool(Tag)>& isType,
     vec.push_back(unbox(form));
   }
 
-  return Vector(env, vec).tag_;
+  return Vector::Make(env, vec);
 }
 
 } /* anonymous namespace */
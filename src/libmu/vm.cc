@@ -0,0 +1,402 @@
+/********
+ **
+ **  SPDX-License-Identifier: MIT
+ **
+ **  Copyright (c) 2017-2022 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  vm.cc: bytecode virtual machine
+ **
+ **/
+#include "libmu/vm.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "libmu/compiler.h"
+#include "libmu/core.h"
+#include "libmu/env.h"
+#include "libmu/type.h"
+
+#include "libmu/types/condition.h"
+#include "libmu/types/cons.h"
+#include "libmu/types/fixnum.h"
+#include "libmu/types/function.h"
+#include "libmu/types/namespace.h"
+#include "libmu/types/string.h"
+#include "libmu/types/symbol.h"
+#include "libmu/types/vector.h"
+
+namespace libmu {
+namespace core {
+namespace {
+
+/** * bytecode assembler **/
+/* assembles a compiled lambda body. anything it doesn't have an operation
+ * for is left to the evaluator. */
+class Assembler {
+ private:
+  Env* env_;
+  std::vector<Tag> code_;
+  std::vector<size_t> labels_;
+  size_t nslots_; /* frame size with blocks */
+  Tag closure_;   /* mu:closure */
+
+  auto Emit(OPCODE op) -> void {
+    code_.push_back(Fixnum(static_cast<uint64_t>(op)).tag_);
+  }
+
+  auto Operand(Tag operand) -> void { code_.push_back(operand); }
+  auto Operand(size_t operand) -> void {
+    code_.push_back(Fixnum(operand).tag_);
+  }
+
+  /* forward label, patched when its target is known */
+  auto Label() -> size_t {
+    code_.push_back(Fixnum(0).tag_);
+    labels_.push_back(code_.size() - 1);
+    return code_.size() - 1;
+  }
+
+  auto Patch(size_t label) -> void { code_[label] = Fixnum(code_.size()).tag_; }
+
+  /** * (:lexref depth . offset) **/
+  auto LexRef(OPCODE op, Tag ref) -> void {
+    auto depth = Fixnum::Uint64Of(Cons::car(Cons::cdr(ref)));
+    auto offset = Fixnum::Uint64Of(Cons::cdr(Cons::cdr(ref)));
+
+    if (op == OPCODE::LEXREF && depth == 0) {
+      Emit(OPCODE::ARG);
+      Operand(offset);
+      return;
+    }
+
+    Emit(op);
+    Operand(depth);
+    Operand(offset);
+  }
+
+  /** * call form, evaluated head **/
+  auto Call(Tag form, bool tail) -> void {
+    auto fn = Cons::car(form);
+    auto args = Cons::cdr(form);
+    auto nargs = Cons::Length(env_, args);
+
+    if (Type::Eq(fn, closure_) && nargs == 1) {
+      Form(Cons::car(args), false);
+      Emit(OPCODE::CLOSURE);
+      return;
+    }
+
+    /* ((predicate ...) form form) is a conditional */
+    if (Cons::IsType(fn) && !IsLexRef(fn) && nargs == 2) {
+      Form(fn, false);
+      Emit(OPCODE::IF);
+      Operand(form);
+      auto nil = Label();
+      auto end = Label();
+      Form(Cons::Nth(args, 0), tail);
+      Emit(OPCODE::JMP);
+      auto join = Label();
+      Patch(nil);
+      Form(Cons::Nth(args, 1), tail);
+      Patch(end);
+      Patch(join);
+      return;
+    }
+
+    Form(fn, false);
+
+    size_t end = 0;
+    if (!Function::IsType(fn)) {
+      Emit(OPCODE::FUNCP);
+      Operand(form);
+      end = Label();
+    }
+
+    Cons::cons_iter<Tag> iter(args);
+    for (auto it = iter.begin(); it != iter.end(); it = ++iter)
+      Form(it->car, false);
+
+    Emit(tail ? OPCODE::TAILCALL : OPCODE::CALL);
+    Operand(nargs);
+
+    if (end) Patch(end);
+  }
+
+  /** * (:let base (form...) . body) **/
+  /* the block's slots are stored in the current frame */
+  auto Let(Tag form, bool tail) -> void {
+    auto slot = Fixnum::Uint64Of(Cons::Nth(form, 1));
+
+    Cons::cons_iter<Tag> iter(Cons::Nth(form, 2));
+    for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
+      Form(it->car, false);
+      Emit(OPCODE::SETLEX);
+      Operand(size_t{0});
+      Operand(slot++);
+      Emit(OPCODE::POP);
+    }
+
+    nslots_ = std::max(nslots_, slot);
+    Forms(Cons::cdr(Cons::cdr(Cons::cdr(form))), tail);
+  }
+
+  /** * special form, keyword head **/
+  auto Special(Tag form, bool tail) -> void {
+    auto fn = Cons::car(form);
+
+    if (Type::Eq(fn, Symbol::Keyword("quote"))) {
+      Emit(OPCODE::CONST);
+      Operand(Cons::Nth(form, 1));
+    } else if (Type::Eq(fn, Symbol::Keyword("t"))) {
+      Form(Cons::Nth(form, 1), tail);
+    } else if (Type::Eq(fn, Symbol::Keyword("nil"))) {
+      Form(Cons::Nth(form, 2), tail);
+    } else if (Type::Eq(fn, Symbol::Keyword("letq")) &&
+               IsLexRef(Cons::Nth(form, 1))) {
+      Form(Cons::Nth(form, 2), false);
+      LexRef(OPCODE::SETLEX, Cons::Nth(form, 1));
+    } else if (Type::Eq(fn, Symbol::Keyword("let"))) {
+      Let(form, tail);
+    } else {
+      Emit(OPCODE::EVAL);
+      Operand(form);
+    }
+  }
+
+  auto Form(Tag form, bool tail) -> void {
+    switch (Type::TypeOf(form)) {
+      case SYS_CLASS::SYMBOL:
+        Emit(Symbol::IsKeyword(form) ? OPCODE::CONST : OPCODE::GREF);
+        Operand(form);
+        break;
+      case SYS_CLASS::CONS:
+        if (IsLexRef(form))
+          LexRef(OPCODE::LEXREF, form);
+        else if (Symbol::IsKeyword(Cons::car(form)))
+          Special(form, tail);
+        else
+          Call(form, tail);
+        break;
+      default: /* constant */
+        Emit(OPCODE::CONST);
+        Operand(form);
+        break;
+    }
+  }
+
+  /** * implicit progn, value of the last form **/
+  auto Forms(Tag body, bool tail) -> void {
+    if (Type::Null(body)) {
+      Emit(OPCODE::CONST);
+      Operand(Type::NIL);
+    }
+
+    Cons::cons_iter<Tag> iter(body);
+    for (auto it = iter.begin(); it != iter.end(); it = ++iter) {
+      auto last = !Cons::IsType(it->cdr);
+
+      Form(it->car, last && tail);
+      if (!last) Emit(OPCODE::POP);
+    }
+  }
+
+ public:
+  /** * lambda body **/
+  /* a frame with blocks is extended on entry, the prologue moves the
+   * labels down. */
+  auto Body(Tag body, size_t nargs) -> Tag {
+    nslots_ = nargs;
+    Forms(body, true);
+    Emit(OPCODE::RET);
+
+    if (nslots_ > nargs) {
+      std::vector<Tag> frame{
+          Fixnum(static_cast<uint64_t>(OPCODE::FRAME)).tag_,
+          Fixnum(nslots_).tag_};
+
+      for (auto label : labels_)
+        code_[label] = Fixnum(Fixnum::Uint64Of(code_[label]) + 2).tag_;
+      code_.insert(code_.begin(), frame.begin(), frame.end());
+    }
+
+    return Vector::Make(env_, code_);
+  }
+
+  explicit Assembler(Env* env)
+      : env_(env),
+        nslots_(0),
+        closure_(Namespace::FindExterns(env->mu_,
+                                        String::MakeImmediate("closure"))) {}
+};
+
+/** * frame of a lexical reference **/
+auto LexFrame(Env::Frame* fp, uint64_t depth) -> Env::Frame* {
+  auto lfp = fp;
+
+  for (; depth; --depth) {
+    lfp = lfp->link;
+    if (lfp == nullptr)
+      Condition::Raise(fp->env, Condition::CONDITION_CLASS::CONTROL_ERROR,
+                       "lexical reference: no enclosing frame (vm)",
+                       fp->func);
+  }
+
+  return lfp;
+}
+
+} /* anonymous namespace */
+
+/** * assemble compiled lambda body **/
+auto Assemble(Env* env, Tag body, size_t nargs) -> Tag {
+  return Assembler(env).Body(body, nargs);
+}
+
+/** * run function body in its frame **/
+auto Exec(Env::Frame* fp) -> void {
+  auto env = fp->env;
+  auto codev = Function::code(fp->func);
+  auto code = Vector::Data<Tag>(codev);
+  auto stack = env->args_.get();
+  auto T = Type::T;
+  auto NIL = Type::NIL;
+
+  Env::ArgMark mark(env);
+
+  /* operands are fixnums, labels offsets into the code */
+  auto operand = [&code](size_t pc) { return Fixnum::Uint64Of(code[pc]); };
+
+  for (size_t pc = 0;;) {
+    switch (static_cast<OPCODE>(operand(pc++))) {
+      case OPCODE::CONST:
+        env->PushArg(code[pc++]);
+        break;
+      case OPCODE::GREF: {
+        auto sym = code[pc++];
+
+        if (!Symbol::IsBound(sym))
+          Condition::Raise(env, Condition::CONDITION_CLASS::UNBOUND_VARIABLE,
+                           "(eval)", sym);
+        env->PushArg(Symbol::value(sym));
+        break;
+      }
+      case OPCODE::ARG:
+        env->PushArg(fp->argv[operand(pc++)]);
+        break;
+      case OPCODE::LEXREF: {
+        auto lfp = LexFrame(fp, operand(pc));
+
+        env->PushArg(lfp->argv[operand(pc + 1)]);
+        pc += 2;
+        break;
+      }
+      case OPCODE::SETLEX: {
+        auto lfp = LexFrame(fp, operand(pc));
+        auto slot = &lfp->argv[operand(pc + 1)];
+        auto value = stack[env->argp_ - 1];
+
+        Env::WriteBarrier(env, lfp, *slot, value);
+        *slot = value;
+        pc += 2;
+        break;
+      }
+      case OPCODE::POP:
+        env->argp_--;
+        break;
+      case OPCODE::FUNCP: {
+        auto fn = stack[env->argp_ - 1];
+
+        if (Function::IsType(fn)) {
+          pc += 2;
+          break;
+        }
+
+        /* the head stays on the stack while the form is evaluated */
+        auto value = EvalCall(env, fn, code[pc]);
+
+        stack[env->argp_ - 1] = value;
+        pc = operand(pc + 1);
+        break;
+      }
+      case OPCODE::TAILCALL: {
+        auto nargs = operand(pc);
+        auto base = env->argp_ - nargs - 1;
+
+        if (Function::TailCall(fp, stack[base], &stack[base + 1], nargs)) {
+          Env::GcPoint(env);
+          codev = Function::code(fp->func);
+          code = Vector::Data<Tag>(codev);
+          pc = 0;
+          break;
+        }
+      }
+      /* fall through */
+      case OPCODE::CALL: {
+        auto nargs = operand(pc++);
+        auto base = env->argp_ - nargs - 1;
+        auto value =
+            Function::Funcall(env, stack[base], &stack[base + 1], nargs);
+
+        env->argp_ = base;
+        env->PushArg(value);
+        break;
+      }
+      case OPCODE::IF: {
+        auto test = stack[env->argp_ - 1];
+
+        if (Type::Eq(test, T)) {
+          env->argp_--;
+          pc += 3;
+        } else if (Type::Eq(test, NIL)) {
+          env->argp_--;
+          pc = operand(pc + 1);
+        } else {
+          auto value = EvalCall(env, test, code[pc]);
+
+          stack[env->argp_ - 1] = value;
+          pc = operand(pc + 2);
+        }
+        break;
+      }
+      case OPCODE::JMP:
+        pc = operand(pc);
+        break;
+      case OPCODE::CLOSURE: {
+        auto fn = stack[env->argp_ - 1];
+
+        if (!Function::IsType(fn))
+          Condition::Raise(env, Condition::CONDITION_CLASS::TYPE_ERROR,
+                           "closure", fn);
+        stack[env->argp_ - 1] = Function::Closure(env, fn);
+        break;
+      }
+      case OPCODE::EVAL:
+        env->PushArg(Eval(env, code[pc++]));
+        break;
+      case OPCODE::RET:
+        fp->value = stack[env->argp_ - 1];
+        return;
+      case OPCODE::FRAME: {
+        auto nslots = operand(pc++);
+        auto top = static_cast<size_t>(fp->argv - stack) + nslots;
+
+        if (top > Env::ARGS_MAX) Env::ArgsExhausted(env);
+        for (auto i = fp->nargs; i < nslots; ++i) fp->argv[i] = NIL;
+
+        fp->nargs = nslots;
+        env->argp_ = std::max(env->argp_, top);
+        break;
+      }
+      default:
+        assert(!"opcode botch");
+    }
+  }
+}
+
+} /* namespace core */
+} /* namespace libmu */
@@ -0,0 +1,53 @@
+/********
+ **
+ **  SPDX-License-Identifier: MIT
+ **
+ **  Copyright (c) 2017-2022 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  vm.h: bytecode virtual machine
+ **
+ **/
+#if !defined(LIBMU_VM_H_)
+#define LIBMU_VM_H_
+
+#include <cassert>
+
+#include "libmu/env.h"
+#include "libmu/type.h"
+
+namespace libmu {
+namespace core {
+
+/** * bytecode operations **/
+/* code is a general vector. an opcode is a fixnum followed by its operands,
+ * labels are fixnum offsets into the vector. the operand stack is the
+ * argument stack, so a call finds its arguments where it expects them. */
+enum class OPCODE : uint64_t {
+  CONST,    /* object: push object */
+  GREF,     /* symbol: push global value */
+  ARG,      /* offset: push argument of the current frame */
+  LEXREF,   /* depth offset: push argument of an enclosing frame */
+  SETLEX,   /* depth offset: store top in an enclosing frame */
+  POP,      /* discard top */
+  FUNCP,    /* form label: not a function, evaluate form the slow way */
+  CALL,     /* nargs: call function under the arguments */
+  TAILCALL, /* nargs: call in tail position, reusing the frame */
+  IF,       /* form label label: :t falls through, :nil takes the first */
+  JMP,      /* label */
+  CLOSURE,  /* close function on top */
+  EVAL,     /* form: push evaluated form */
+  RET,      /* return top */
+  FRAME     /* nslots: extend the frame over its blocks' slots */
+};
+
+Tag Assemble(Env*, Tag, size_t);
+void Exec(Env::Frame*);
+
+} /* namespace core */
+} /* namespace libmu */
+
+#endif /* LIBMU_VM_H_ */
@@ -21,7 +21,7 @@ extern void make_opts(Platform *, int, char **, const char *);
 int main(int argc, char **argv) {
   Platform *platform = new Platform();
 
-  make_opts(platform, argc, argv, "ivhe:q:l:");
+  make_opts(platform, argc, argv, "ivhe:q:l:H:M:TI:");
   repl(platform, argc);
 
   return 0;
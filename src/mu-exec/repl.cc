@@ -11,6 +11,7 @@
  **  repl.cc: mu-exec repl
  **
  **/
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -24,8 +25,20 @@ using libmu::platform::Platform;
 void repl(Platform *platform, int) {
   auto env = reinterpret_cast<void *>(libmu::api::env_default(platform));
 
+  if (env == nullptr) {
+    std::cerr << "mu-exec: can't load image "
+              << Platform::value(platform->Find("I")) << std::endl;
+    exit(1);
+  }
+
   libmu::api::withCondition(env, [platform](void *env) {
-    auto repl = platform->options_->size() == 0;
+    /* heap options alone still enter the repl */
+    auto repl = std::all_of(
+        platform->options_->begin(), platform->options_->end(),
+        [](const Platform::OptMap &opt) {
+          return std::string("HMTI").find(Platform::name(opt)[0]) !=
+                 std::string::npos;
+        });
 
     for (const Platform::OptMap &opt : *platform->options_) {
       switch (platform->name(opt)[0]) {
@@ -42,6 +55,10 @@ void repl(Platform *platform, int) {
             "  -l SRCFILE           load SRCFILE in sequence\n"
             "  -e SEXPR             evaluate SEXPR and print result\n"
             "  -q SEXPR             evaluate SEXPR quietly\n"
+            "  -H MBYTES            initial heap size, default 64\n"
+            "  -M MBYTES            maximum heap size, default 1024\n"
+            "  -T                   use transparent huge pages\n"
+            "  -I IMAGE             start from heap IMAGE\n"
             "  src-file...          load source files\n";
 
         std::cout << helpmsg << std::endl;